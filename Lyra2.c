@@ -23,6 +23,7 @@
 #include <time.h>
 #include "Lyra2.h"
 #include "Sponge.h"
+#include "scratchpad.h"
 
 /**
  * Executes Lyra2 based on the G function from Blake2b. This version supports salts and passwords
@@ -64,17 +65,15 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
     const int64_t ROW_LEN_BYTES = ROW_LEN_INT64 * 8;
 
     i = (int64_t) ((int64_t) nRows * (int64_t) ROW_LEN_BYTES);
-    uint64_t *wholeMatrix = malloc(i);
+    //The row pointers and the sponge state live right after the matrix in the thread's scratchpad
+    uint64_t *wholeMatrix = scratchpad_acquire(i + nRows * sizeof (uint64_t*) + 16 * sizeof (uint64_t));
     if (wholeMatrix == NULL) {
       return -1;
     }
 	memset(wholeMatrix, 0, i);
 
-    //Allocates pointers to each row of the matrix
-    uint64_t **memMatrix = malloc(nRows * sizeof (uint64_t*));
-    if (memMatrix == NULL) {
-      return -1;
-    }
+    //Pointers to each row of the matrix
+    uint64_t **memMatrix = (uint64_t**) ((byte*) wholeMatrix + i);
     //Places the pointers in the correct positions
     uint64_t *ptrWord = wholeMatrix;
     for (i = 0; i < nRows; i++) {
@@ -123,10 +122,7 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
 
     //======================= Initializing the Sponge State ====================//
     //Sponge state: 16 uint64_t, BLOCK_LEN_INT64 words of them for the bitrate (b) and the remainder for the capacity (c)
-    uint64_t *state = malloc(16 * sizeof (uint64_t));
-    if (state == NULL) {
-      return -1;
-    }
+    uint64_t *state = (uint64_t*) (memMatrix + nRows);
     initState(state);
     //==========================================================================/
 
@@ -201,12 +197,9 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
     //==========================================================================/
 
     //========================= Freeing the memory =============================//
-    free(memMatrix);
-    free(wholeMatrix);
-
-    //Wiping out the sponge's internal state before freeing it
+    //Wiping out the sponge's internal state before handing the scratchpad back
     memset(state, 0, 16 * sizeof (uint64_t));
-    free(state);
+    scratchpad_release(wholeMatrix);
     //==========================================================================/
 
     return 0;
@@ -233,17 +226,15 @@ int LYRA2_old(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const vo
     const int64_t ROW_LEN_BYTES = ROW_LEN_INT64 * 8;
 
     i = (int64_t) ((int64_t) nRows * (int64_t) ROW_LEN_BYTES);
-    uint64_t *wholeMatrix = malloc(i);
+    //The row pointers and the sponge state live right after the matrix in the thread's scratchpad
+    uint64_t *wholeMatrix = scratchpad_acquire(i + nRows * sizeof (uint64_t*) + 16 * sizeof (uint64_t));
     if (wholeMatrix == NULL) {
       return -1;
     }
 	memset(wholeMatrix, 0, i);
 
-    //Allocates pointers to each row of the matrix
-    uint64_t **memMatrix = malloc(nRows * sizeof (uint64_t*));
-    if (memMatrix == NULL) {
-      return -1;
-    }
+    //Pointers to each row of the matrix
+    uint64_t **memMatrix = (uint64_t**) ((byte*) wholeMatrix + i);
     //Places the pointers in the correct positions
     uint64_t *ptrWord = wholeMatrix;
     for (i = 0; i < nRows; i++) {
@@ -292,10 +283,7 @@ int LYRA2_old(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const vo
 
     //======================= Initializing the Sponge State ====================//
     //Sponge state: 16 uint64_t, BLOCK_LEN_INT64 words of them for the bitrate (b) and the remainder for the capacity (c)
-    uint64_t *state = malloc(16 * sizeof (uint64_t));
-    if (state == NULL) {
-      return -1;
-    }
+    uint64_t *state = (uint64_t*) (memMatrix + nRows);
     initState(state);
     //==========================================================================/
 
@@ -370,12 +358,9 @@ int LYRA2_old(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const vo
     //==========================================================================/
 
     //========================= Freeing the memory =============================//
-    free(memMatrix);
-    free(wholeMatrix);
-
-    //Wiping out the sponge's internal state before freeing it
+    //Wiping out the sponge's internal state before handing the scratchpad back
     memset(state, 0, 16 * sizeof (uint64_t));
-    free(state);
+    scratchpad_release(wholeMatrix);
     //==========================================================================/
 
     return 0;
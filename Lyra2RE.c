@@ -33,6 +33,7 @@
 #include <string.h>
 #include <stdio.h>
 #include "sha3/sph_blake.h"
+#include "sha3/blake256_8way.h"
 #include "sha3/sph_groestl.h"
 #include "sha3/sph_cubehash.h"
 #include "sha3/sph_bmw.h"
@@ -40,24 +41,24 @@
 #include "sha3/sph_skein.h"
 #include "Lyra2.h"
 
-void lyra2re_hash(const char* input, char* output)
+/* everything after the blake256 of the header, hashA holding that */
+static void lyra2re_stages(uint32_t* hashA, char* output)
 {
-    sph_blake256_context     ctx_blake;
     sph_groestl256_context   ctx_groestl;
     sph_keccak256_context    ctx_keccak;
     sph_skein256_context     ctx_skein;
 
-    uint32_t hashA[8], hashB[8];
-
-    sph_blake256_init(&ctx_blake);
-    sph_blake256 (&ctx_blake, input, 80);
-    sph_blake256_close (&ctx_blake, hashA);
+    uint32_t hashB[8];
 
     sph_keccak256_init(&ctx_keccak);
     sph_keccak256 (&ctx_keccak,hashA, 32);
     sph_keccak256_close(&ctx_keccak, hashB);
 
-	LYRA2_old(hashA, 32, hashB, 32, hashB, 32, 1, 8, 8);
+	if (LYRA2_old(hashA, 32, hashB, 32, hashB, 32, 1, 8, 8) < 0) {
+		/* no scratchpad */
+		memset(output, 0, 32);
+		return;
+	}
 
 	sph_skein256_init(&ctx_skein);
     sph_skein256 (&ctx_skein, hashA, 32);
@@ -70,19 +71,69 @@ void lyra2re_hash(const char* input, char* output)
 	memcpy(output, hashA, 32);
 }
 
-void lyra2re2_hash(const char* input, char* output)
+void lyra2re_hash(const char* input, char* output)
+{
+    sph_blake256_context ctx_blake;
+    uint32_t hashA[8];
+
+    sph_blake256_init(&ctx_blake);
+    sph_blake256 (&ctx_blake, input, 80);
+    sph_blake256_close (&ctx_blake, hashA);
+
+    lyra2re_stages(hashA, output);
+}
+
+/* the blake256 of up to eight headers, the other stages lane by lane */
+static void lyra2re_lanes(const char* const* input, char* const* output, uint32_t count,
+    void (*hash)(const char*, char*), void (*stages)(uint32_t*, char*))
+{
+    uint32_t hashA[8][8];
+    void *dst[8];
+    uint32_t i;
+
+    for (i = 0; i < 8; i++)
+        dst[i] = hashA[i];
+
+    for (; count >= 8 && blake256_8way_available(); input += 8, output += 8, count -= 8) {
+        const void *src[8];
+
+        for (i = 0; i < 8; i++)
+            src[i] = input[i];
+        blake256_8way_80(src, dst);
+
+        for (i = 0; i < 8; i++)
+            stages(hashA[i], output[i]);
+    }
+
+    for (i = 0; i < count; i++)
+        hash(input[i], output[i]);
+}
+
+void lyra2re_multi_hash(const char* const* input, char* const* output, uint32_t count)
+{
+    lyra2re_lanes(input, output, count, lyra2re_hash, lyra2re_stages);
+}
+
+void lyra2re_hash_nonce(const void* state, const char* header, char* output)
+{
+    sph_blake256_context ctx_blake = *(const sph_blake256_context*)state;
+    uint32_t hashA[8];
+
+    sph_blake256 (&ctx_blake, header + 76, 4);
+    sph_blake256_close (&ctx_blake, hashA);
+
+    lyra2re_stages(hashA, output);
+}
+
+/* everything after the blake256 of the header, hashA holding that */
+static void lyra2re2_stages(uint32_t* hashA, char* output)
 {
-	sph_blake256_context ctx_blake;
 	sph_cubehash256_context ctx_cubehash;
 	sph_keccak256_context ctx_keccak;
 	sph_skein256_context ctx_skein;
 	sph_bmw256_context ctx_bmw;
 
-	uint32_t hashA[8], hashB[8];
-
-	sph_blake256_init(&ctx_blake);
-    sph_blake256(&ctx_blake, input, 80);
-    sph_blake256_close (&ctx_blake, hashA);
+	uint32_t hashB[8];
 
     sph_keccak256_init(&ctx_keccak);
     sph_keccak256(&ctx_keccak, hashA, 32);
@@ -92,7 +143,11 @@ void lyra2re2_hash(const char* input, char* output)
     sph_cubehash256(&ctx_cubehash, hashB, 32);
     sph_cubehash256_close(&ctx_cubehash, hashA);
 
-    LYRA2(hashB, 32, hashA, 32, hashA, 32, 1, 4, 4);
+    if (LYRA2(hashB, 32, hashA, 32, hashA, 32, 1, 4, 4) < 0) {
+        /* no scratchpad */
+        memset(output, 0, 32);
+        return;
+    }
 
    	sph_skein256_init(&ctx_skein);
     sph_skein256(&ctx_skein, hashB, 32);
@@ -108,3 +163,31 @@ void lyra2re2_hash(const char* input, char* output)
 
    	memcpy(output, hashA, 32);
 }
+
+void lyra2re2_hash(const char* input, char* output)
+{
+	sph_blake256_context ctx_blake;
+	uint32_t hashA[8];
+
+	sph_blake256_init(&ctx_blake);
+    sph_blake256(&ctx_blake, input, 80);
+    sph_blake256_close (&ctx_blake, hashA);
+
+    lyra2re2_stages(hashA, output);
+}
+
+void lyra2re2_hash_nonce(const void* state, const char* header, char* output)
+{
+	sph_blake256_context ctx_blake = *(const sph_blake256_context*)state;
+	uint32_t hashA[8];
+
+    sph_blake256(&ctx_blake, header + 76, 4);
+    sph_blake256_close (&ctx_blake, hashA);
+
+    lyra2re2_stages(hashA, output);
+}
+
+void lyra2re2_multi_hash(const char* const* input, char* const* output, uint32_t count)
+{
+    lyra2re_lanes(input, output, count, lyra2re2_hash, lyra2re2_stages);
+}
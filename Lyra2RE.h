@@ -5,9 +5,19 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
 void lyra2re_hash(const char* input, char* output);
 void lyra2re2_hash(const char* input, char* output);
 
+/* count 80 byte headers, the blake256 stage eight at a time */
+void lyra2re_multi_hash(const char* const* input, char* const* output, uint32_t count);
+void lyra2re2_multi_hash(const char* const* input, char* const* output, uint32_t count);
+
+/* state comes from blake_hash_prepare(), both start with blake256 of the header */
+void lyra2re_hash_nonce(const void* state, const char* header, char* output);
+void lyra2re2_hash_nonce(const void* state, const char* header, char* output);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,248 @@
+#include "algorithms.h"
+#include <string.h>
+
+#include "bcrypt.h"
+#include "keccak.h"
+#include "quark.h"
+#include "scryptn.h"
+#include "yescrypt/yescrypt.h"
+#include "neoscrypt.h"
+#include "skein.h"
+#include "x11.h"
+#include "groestl.h"
+#include "blake.h"
+#include "blake2s.h"
+#include "fugue.h"
+#include "qubit.h"
+#include "s3.h"
+#include "hefty1.h"
+#include "shavite3.h"
+#include "cryptonight.h"
+#include "x13.h"
+#include "x14.h"
+#include "nist5.h"
+#include "sha1.h"
+#include "x15.h"
+#include "x17.h"
+#include "fresh.h"
+#include "dcrypt.h"
+#include "jh.h"
+#include "x5.h"
+#include "c11.h"
+#include "whirlpoolx.h"
+#include "zr5.h"
+#include "Lyra2RE.h"
+#include "sha3/sph_blake.h"
+#include "sha3/sph_skein.h"
+
+/* Adapters giving every hash the algorithm_hash_fn signature. */
+
+#define HASH_WITH_LEN(fn) \
+    static void fn##_algorithm(const char* input, char* output, uint32_t len, const algorithm_params* params) \
+    { fn(input, output, len); }
+
+#define HASH_FIXED(fn) \
+    static void fn##_algorithm(const char* input, char* output, uint32_t len, const algorithm_params* params) \
+    { fn(input, output); }
+
+HASH_WITH_LEN(quark_hash)
+HASH_WITH_LEN(x11_hash)
+HASH_WITH_LEN(keccak_hash)
+HASH_FIXED(bcrypt_hash)
+HASH_WITH_LEN(skein_hash)
+HASH_WITH_LEN(groestl_hash)
+HASH_WITH_LEN(groestlmyriad_hash)
+HASH_WITH_LEN(blake_hash)
+HASH_WITH_LEN(fugue_hash)
+HASH_WITH_LEN(qubit_hash)
+HASH_WITH_LEN(hefty1_hash)
+HASH_WITH_LEN(shavite3_hash)
+HASH_WITH_LEN(cryptonight_hash)
+HASH_WITH_LEN(cryptonight_fast_hash)
+HASH_WITH_LEN(x13_hash)
+HASH_WITH_LEN(nist5_hash)
+HASH_WITH_LEN(sha1_hash)
+HASH_WITH_LEN(x15_hash)
+HASH_WITH_LEN(x17_hash)
+HASH_WITH_LEN(fresh_hash)
+HASH_WITH_LEN(whirlpoolx_hash)
+HASH_FIXED(yescrypt_hash)
+HASH_FIXED(lyra2re_hash)
+HASH_FIXED(lyra2re2_hash)
+HASH_WITH_LEN(s3_hash)
+HASH_WITH_LEN(jh_hash)
+HASH_WITH_LEN(x14_hash)
+HASH_FIXED(c11_hash)
+HASH_WITH_LEN(dcrypt_hash)
+HASH_FIXED(x5_hash)
+
+static void blake2s_hash_algorithm(const char* input, char* output, uint32_t len, const algorithm_params* params)
+{
+    blake2s_hash(input, output, (int)len);
+}
+
+static void zr5_hash_algorithm(const char* input, char* output, uint32_t len, const algorithm_params* params)
+{
+    zr5_hash((void*)input, output, len);
+}
+
+static void scrypt_algorithm(const char* input, char* output, uint32_t len, const algorithm_params* params)
+{
+    scrypt_N_R_1_256(input, output, params->n, params->r, len);
+}
+
+static void scryptn_algorithm(const char* input, char* output, uint32_t len, const algorithm_params* params)
+{
+    scrypt_N_R_1_256(input, output, 1 << params->n, 1, len);
+}
+
+static void blake_nonce_algorithm(const void* state, const char* header, char* output, const algorithm_params* params)
+{
+    blake_hash_nonce(state, header, output);
+}
+
+static void skein_nonce_algorithm(const void* state, const char* header, char* output, const algorithm_params* params)
+{
+    skein_hash_nonce(state, header, output);
+}
+
+static void lyra2re_nonce_algorithm(const void* state, const char* header, char* output, const algorithm_params* params)
+{
+    lyra2re_hash_nonce(state, header, output);
+}
+
+static void lyra2re2_nonce_algorithm(const void* state, const char* header, char* output, const algorithm_params* params)
+{
+    lyra2re2_hash_nonce(state, header, output);
+}
+
+static void scrypt_nonce_algorithm(const void* state, const char* header, char* output, const algorithm_params* params)
+{
+    scrypt_N_R_1_256_nonce(state, header, output, params->n, params->r);
+}
+
+static void scryptn_nonce_algorithm(const void* state, const char* header, char* output, const algorithm_params* params)
+{
+    scrypt_N_R_1_256_nonce(state, header, output, 1 << params->n, 1);
+}
+
+/* every prepared state has to fit in ALGORITHM_PREPARED_SIZE, scryptn.c checks its own */
+typedef char prepared_state_fits[
+    sizeof(sph_blake256_context) <= ALGORITHM_PREPARED_SIZE &&
+    sizeof(sph_skein512_context) <= ALGORITHM_PREPARED_SIZE ? 1 : -1];
+
+/* Adapters giving the multi-input kernels the algorithm_multi_fn signature. */
+
+#define MULTI_WITH_LEN(fn) \
+    static void fn##_algorithm(const char* const* inputs, char* const* outputs, const uint32_t* lens, uint32_t count, const algorithm_params* params) \
+    { fn(inputs, outputs, lens, count); }
+
+#define MULTI_FIXED(fn) \
+    static void fn##_algorithm(const char* const* inputs, char* const* outputs, const uint32_t* lens, uint32_t count, const algorithm_params* params) \
+    { fn(inputs, outputs, count); }
+
+MULTI_WITH_LEN(cryptonight_multi_hash)
+MULTI_WITH_LEN(blake_multi_hash)
+MULTI_WITH_LEN(quark_multi_hash)
+MULTI_WITH_LEN(x11_multi_hash)
+MULTI_WITH_LEN(x13_multi_hash)
+MULTI_WITH_LEN(x15_multi_hash)
+MULTI_WITH_LEN(x17_multi_hash)
+MULTI_FIXED(x14_multi_hash)
+MULTI_FIXED(c11_multi_hash)
+MULTI_FIXED(lyra2re_multi_hash)
+MULTI_FIXED(lyra2re2_multi_hash)
+
+static void neoscrypt_algorithm(const char* input, char* output, uint32_t len, const algorithm_params* params)
+{
+    neoscrypt((const unsigned char*)input, (unsigned char*)output, params->n);
+}
+
+#define SCRYPT_MEMORY(N, r)     (128 * (size_t)(N) * (r) + 128 * (size_t)(r) + 256 * (size_t)(r) + 64 + 64)
+#define NEOSCRYPT_MEMORY(N, r)  (((size_t)(N) + 3) * (r) * 128 + 64)
+#define YESCRYPT_MEMORY         (128 * 8 * 2048 + 128 * 8 + 256 * 8 + 8192)
+#define CRYPTONIGHT_MEMORY      (1 << 21)
+#define DCRYPT_MEMORY           (1048576 + 1024)
+
+#define SAFE        ALGORITHM_THREAD_SAFE
+#define HARD        (ALGORITHM_THREAD_SAFE | ALGORITHM_MEMORY_HARD)
+
+const algorithm_t algorithms[ALGO_COUNT] = {
+    [ALGO_QUARK]            = { "quark", quark_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE, quark_multi_hash_algorithm, 4 },
+    [ALGO_X11]              = { "x11", x11_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE, x11_multi_hash_algorithm, 4 },
+    [ALGO_SCRYPT]           = { "scrypt", scrypt_algorithm, 0, 32, 2, { 1024, 1 }, SCRYPT_MEMORY(1024, 1), HARD,
+                                NULL, 0, scrypt_N_R_1_256_prepare, scrypt_nonce_algorithm },
+    [ALGO_SCRYPTN]          = { "scryptn", scryptn_algorithm, 0, 32, 1, { 10, 0 }, SCRYPT_MEMORY(1 << 10, 1), HARD,
+                                NULL, 0, scrypt_N_R_1_256_prepare, scryptn_nonce_algorithm },
+    [ALGO_KECCAK]           = { "keccak", keccak_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_BCRYPT]           = { "bcrypt", bcrypt_hash_algorithm, 80, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_SKEIN]            = { "skein", skein_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE,
+                                NULL, 0, skein_hash_prepare, skein_nonce_algorithm },
+    [ALGO_GROESTL]          = { "groestl", groestl_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_GROESTLMYRIAD]    = { "groestlmyriad", groestlmyriad_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_BLAKE]            = { "blake", blake_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE,
+                                blake_multi_hash_algorithm, 8, blake_hash_prepare, blake_nonce_algorithm },
+    [ALGO_BLAKE2S]          = { "blake2s", blake2s_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_FUGUE]            = { "fugue", fugue_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_QUBIT]            = { "qubit", qubit_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_HEFTY1]           = { "hefty1", hefty1_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_SHAVITE3]         = { "shavite3", shavite3_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_CRYPTONIGHT]      = { "cryptonight", cryptonight_hash_algorithm, 0, 32, 0, { 0, 0 }, CRYPTONIGHT_MEMORY, HARD, cryptonight_multi_hash_algorithm, CRYPTONIGHT_MAX_WAYS },
+    [ALGO_CRYPTONIGHT_FAST] = { "cryptonightfast", cryptonight_fast_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_X13]              = { "x13", x13_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE, x13_multi_hash_algorithm, 4 },
+    [ALGO_NIST5]            = { "nist5", nist5_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_SHA1]             = { "sha1", sha1_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_X15]              = { "x15", x15_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE, x15_multi_hash_algorithm, 4 },
+    [ALGO_X17]              = { "x17", x17_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE, x17_multi_hash_algorithm, 4 },
+    [ALGO_FRESH]            = { "fresh", fresh_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_WHIRLPOOLX]       = { "whirlpoolx", whirlpoolx_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_ZR5]              = { "zr5", zr5_hash_algorithm, 80, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_NEOSCRYPT]        = { "neoscrypt", neoscrypt_algorithm, 80, 32, 1, { 0, 0 }, NEOSCRYPT_MEMORY(128, 2), HARD },
+    [ALGO_YESCRYPT]         = { "yescrypt", yescrypt_hash_algorithm, 80, 32, 0, { 0, 0 }, YESCRYPT_MEMORY, HARD },
+    [ALGO_LYRA2RE]          = { "lyra2re", lyra2re_hash_algorithm, 80, 32, 0, { 0, 0 }, 8 * 8 * 96, SAFE,
+                                lyra2re_multi_hash_algorithm, 8, blake_hash_prepare, lyra2re_nonce_algorithm },
+    [ALGO_LYRA2RE2]         = { "lyra2re2", lyra2re2_hash_algorithm, 80, 32, 0, { 0, 0 }, 4 * 4 * 96, SAFE,
+                                lyra2re2_multi_hash_algorithm, 8, blake_hash_prepare, lyra2re2_nonce_algorithm },
+    [ALGO_S3]               = { "s3", s3_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_JH]               = { "jh", jh_hash_algorithm, 0, 32, 0, { 0, 0 }, 0, SAFE },
+    [ALGO_X14]              = { "x14", x14_hash_algorithm, 80, 32, 0, { 0, 0 }, 0, SAFE, x14_multi_hash_algorithm, 4 },
+    [ALGO_C11]              = { "c11", c11_hash_algorithm, 80, 32, 0, { 0, 0 }, 0, SAFE, c11_multi_hash_algorithm, 4 },
+    [ALGO_DCRYPT]           = { "dcrypt", dcrypt_hash_algorithm, 0, 32, 0, { 0, 0 }, DCRYPT_MEMORY, HARD },
+    [ALGO_X5]               = { "x5", x5_hash_algorithm, 80, 32, 0, { 0, 0 }, 0, SAFE }
+};
+
+const algorithm_t* algorithm_find(const char* name)
+{
+    int i;
+
+    for (i = 0; i < ALGO_COUNT; i++) {
+        if (strcmp(algorithms[i].name, name) == 0)
+            return &algorithms[i];
+    }
+
+    return NULL;
+}
+
+size_t algorithm_memory(const algorithm_t* algo, const algorithm_params* params)
+{
+    uint32_t profile;
+
+    if (params == NULL)
+        return algo->memory;
+
+    switch (algo - algorithms) {
+    case ALGO_SCRYPT:
+        return SCRYPT_MEMORY(params->n, params->r);
+    case ALGO_SCRYPTN:
+        return SCRYPT_MEMORY((size_t)1 << params->n, 1);
+    case ALGO_NEOSCRYPT:
+        profile = params->n;
+        if (profile >> 31)
+            return NEOSCRYPT_MEMORY((size_t)1 << (((profile >> 8) & 0x1F) + 1), 1 << ((profile >> 5) & 0x7));
+        if (profile & 0x1)
+            return NEOSCRYPT_MEMORY(1024, 1);
+        return NEOSCRYPT_MEMORY(128, 2);
+    default:
+        return algo->memory;
+    }
+}
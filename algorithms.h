@@ -0,0 +1,102 @@
+#ifndef ALGORITHMS_H
+#define ALGORITHMS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Ids are indexes into algorithms[] and are exposed to JS, so only append. */
+enum algorithm_id {
+    ALGO_QUARK,
+    ALGO_X11,
+    ALGO_SCRYPT,
+    ALGO_SCRYPTN,
+    ALGO_KECCAK,
+    ALGO_BCRYPT,
+    ALGO_SKEIN,
+    ALGO_GROESTL,
+    ALGO_GROESTLMYRIAD,
+    ALGO_BLAKE,
+    ALGO_BLAKE2S,
+    ALGO_FUGUE,
+    ALGO_QUBIT,
+    ALGO_HEFTY1,
+    ALGO_SHAVITE3,
+    ALGO_CRYPTONIGHT,
+    ALGO_CRYPTONIGHT_FAST,
+    ALGO_X13,
+    ALGO_NIST5,
+    ALGO_SHA1,
+    ALGO_X15,
+    ALGO_X17,
+    ALGO_FRESH,
+    ALGO_WHIRLPOOLX,
+    ALGO_ZR5,
+    ALGO_NEOSCRYPT,
+    ALGO_YESCRYPT,
+    ALGO_LYRA2RE,
+    ALGO_LYRA2RE2,
+    ALGO_S3,
+    ALGO_JH,
+    ALGO_X14,
+    ALGO_C11,
+    ALGO_DCRYPT,
+    ALGO_X5,
+    ALGO_COUNT
+};
+
+/* Tunables of the parameterised algorithms, ignored by all the others. */
+typedef struct {
+    uint32_t n;     /* scrypt N, scryptn N-factor or neoscrypt profile */
+    uint32_t r;     /* scrypt r */
+} algorithm_params;
+
+typedef void (*algorithm_hash_fn)(const char* input, char* output, uint32_t len, const algorithm_params* params);
+
+/* Hashes count independent inputs at once, count being 1 to the algorithm's lanes. */
+typedef void (*algorithm_multi_fn)(const char* const* inputs, char* const* outputs, const uint32_t* lens, uint32_t count, const algorithm_params* params);
+
+/*
+ * Nonce-only hashing of 80 byte headers. prepare absorbs the constant first
+ * 76 bytes into state, up to ALGORITHM_PREPARED_SIZE bytes, and hash_nonce
+ * resumes from a copy of it for the full header with its nonce filled in.
+ */
+#define ALGORITHM_PREPARED_SIZE 256
+
+typedef void (*algorithm_prepare_fn)(void* state, const char* header);
+typedef void (*algorithm_nonce_fn)(const void* state, const char* header, char* output, const algorithm_params* params);
+
+/* algorithm flags */
+#define ALGORITHM_THREAD_SAFE   0x1     /* several threads may hash at once */
+#define ALGORITHM_MEMORY_HARD   0x2     /* cost is dominated by the scratchpad */
+
+typedef struct {
+    const char* name;
+    algorithm_hash_fn hash;
+    uint32_t input_len;         /* bytes read from the input, 0 for any length */
+    uint32_t output_len;
+    uint32_t param_count;       /* leading algorithm_params fields the hash reads */
+    algorithm_params defaults;
+    size_t memory;              /* scratchpad bytes per hash with the default params */
+    uint32_t flags;
+    algorithm_multi_fn hash_multi;  /* interleaved kernel for batches, NULL if none */
+    uint32_t lanes;                 /* inputs hash_multi gains the most from */
+    algorithm_prepare_fn prepare;   /* midstate of an 80 byte header, NULL if none */
+    algorithm_nonce_fn hash_nonce;
+} algorithm_t;
+
+extern const algorithm_t algorithms[ALGO_COUNT];
+
+const algorithm_t* algorithm_find(const char* name);
+
+/* Scratchpad bytes one hash needs with the given params (NULL for the defaults). */
+size_t algorithm_memory(const algorithm_t* algo, const algorithm_params* params);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
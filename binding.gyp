@@ -4,6 +4,10 @@
             "target_name": "multihashing",
             "sources": [
                 "multihashing.cc",
+                "workpool.cc",
+                "algorithms.c",
+                "scratchpad.c",
+                "cpu.c",
                 "scryptn.c",
                 "yescrypt/sha256_Y.c",
                 "yescrypt/yescrypt-best.c",
@@ -23,6 +27,7 @@
                 "cryptonight.c",
                 "x13.c",
                 "x14.c",
+                "x5.c",
                 "boolberry.cc",
                 "nist5.c",
                 "sha1.c",
@@ -44,15 +49,21 @@
                 "sha3/sph_fugue.c",
                 "sha3/aes_helper.c",
                 "sha3/sph_blake.c",
+                "sha3/blake512_4way.c",
+                "sha3/blake256_8way.c",
                 "sha3/sph_bmw.c",
                 "sha3/sph_cubehash.c",
                 "sha3/sph_echo.c",
+                "sha3/echo_aesni.c",
                 "sha3/sph_groestl.c",
+                "sha3/groestl_aesni.c",
                 "sha3/sph_jh.c",
                 "sha3/sph_keccak.c",
                 "sha3/sph_luffa.c",
                 "sha3/sph_shavite.c",
+                "sha3/shavite_aesni.c",
                 "sha3/sph_simd.c",
+                "sha3/simd_vec.c",
                 "sha3/sph_skein.c",
                 "sha3/sph_whirlpool.c",
                 "sha3/sph_shabal.c",
@@ -5,6 +5,7 @@
 #include <stdio.h>
 
 #include "sha3/sph_blake.h"
+#include "sha3/blake256_8way.h"
 
 
 void blake_hash(const char* input, char* output, uint32_t len)
@@ -15,3 +16,50 @@ void blake_hash(const char* input, char* output, uint32_t len)
     sph_blake256_close(&ctx_blake, output);
 }
 
+/* eight equal length inputs at a time through the 8-way kernel */
+void blake_multi_hash(const char* const* input, char* const* output, const uint32_t* len, uint32_t count)
+{
+    uint32_t i;
+
+    for (; count >= 8 && blake256_8way_available(); input += 8, output += 8, len += 8, count -= 8) {
+        const void *src[8];
+        void *dst[8];
+
+        for (i = 1; i < 8 && len[i] == len[0]; i++)
+            ;
+        if (i < 8)
+            break;
+
+        for (i = 0; i < 8; i++) {
+            src[i] = input[i];
+            dst[i] = output[i];
+        }
+
+        if (len[0] == 80) {
+            blake256_8way_80(src, dst);
+        } else {
+            blake256_8way_context ctx;
+
+            blake256_8way_init(&ctx);
+            blake256_8way_update(&ctx, src, len[0]);
+            blake256_8way_close(&ctx, dst);
+        }
+    }
+
+    for (i = 0; i < count; i++)
+        blake_hash(input[i], output[i], len[i]);
+}
+
+void blake_hash_prepare(void* state, const char* header)
+{
+    sph_blake256_init(state);
+    sph_blake256(state, header, 76);
+}
+
+void blake_hash_nonce(const void* state, const char* header, char* output)
+{
+    sph_blake256_context ctx_blake = *(const sph_blake256_context*)state;
+    sph_blake256(&ctx_blake, header + 76, 4);
+    sph_blake256_close(&ctx_blake, output);
+}
+
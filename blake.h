@@ -8,6 +8,14 @@ extern "C" {
 #include <stdint.h>
 
 void blake_hash(const char* input, char* output, uint32_t len);
+void blake_multi_hash(const char* const* input, char* const* output, const uint32_t* len, uint32_t count);
+
+/*
+ * Nonce-only hashing of 80 byte headers: prepare absorbs the first 76 bytes
+ * into state (a sph_blake256_context), nonce resumes from it with the last 4.
+ */
+void blake_hash_prepare(void* state, const char* header);
+void blake_hash_nonce(const void* state, const char* header, char* output);
 
 #ifdef __cplusplus
 }
@@ -14,11 +14,12 @@
 #include "sha3/sph_cubehash.h"
 #include "sha3/sph_shavite.h"
 #include "sha3/sph_simd.h"
-#include "sha3/sph_echo.h"
+#include "sha3/echo_aesni.h"
+#include "sha3/blake512_4way.h"
 
-void c11_hash(const char* input, char* output)
+/* stages 2 to 11, from the blake512 digest in hashA */
+static void c11_chain(uint32_t hashA[16], char* output)
 {
-    sph_blake512_context     ctx_blake;
     sph_bmw512_context       ctx_bmw;
     sph_groestl512_context   ctx_groestl;
     sph_skein512_context     ctx_skein;
@@ -28,15 +29,11 @@ void c11_hash(const char* input, char* output)
     sph_cubehash512_context  ctx_cubehash1;
     sph_shavite512_context   ctx_shavite1;
     sph_simd512_context      ctx_simd1;
-    sph_echo512_context      ctx_echo1;
 
-    uint32_t hashA[16], hashB[16];
+    uint32_t hashB[16];
 
     //blake-bmw-groestl-sken-jh-meccak-luffa-cubehash-shivite-simd-echo
 
-    sph_blake512_init(&ctx_blake);
-    sph_blake512 (&ctx_blake, input, 80);
-    sph_blake512_close (&ctx_blake, hashA);
 
     sph_bmw512_init(&ctx_bmw);
     sph_bmw512 (&ctx_bmw, hashA, 64);
@@ -74,10 +71,26 @@ void c11_hash(const char* input, char* output)
     sph_simd512 (&ctx_simd1, hashA, 64);
     sph_simd512_close(&ctx_simd1, hashB);
 
-    sph_echo512_init (&ctx_echo1);
-    sph_echo512 (&ctx_echo1, hashB, 64);
-    sph_echo512_close(&ctx_echo1, hashA);
+    echo512_64(hashB, hashA);
 
     memcpy(output, hashA, 32);
 
 }
+
+void c11_hash(const char* input, char* output)
+{
+    sph_blake512_context     ctx_blake;
+    uint32_t hashA[16];
+
+    sph_blake512_init(&ctx_blake);
+    sph_blake512 (&ctx_blake, input, 80);
+    sph_blake512_close (&ctx_blake, hashA);
+
+    c11_chain(hashA, output);
+}
+
+/* four inputs share one 4-way blake512 pass, each hashed as 80 bytes like c11_hash */
+void c11_multi_hash(const char* const* input, char* const* output, uint32_t count)
+{
+    blake512_4way_chain(input, output, NULL, count, c11_chain);
+}
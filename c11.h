@@ -8,6 +8,7 @@ extern "C" {
 #include <stdint.h>
 
 void c11_hash(const char* input, char* output);
+void c11_multi_hash(const char* const* input, char* const* output, uint32_t count);
 
 #ifdef __cplusplus
 }
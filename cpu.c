@@ -0,0 +1,51 @@
+#include "cpu.h"
+
+#ifdef CPU_X86
+#include <cpuid.h>
+#endif
+
+#define CPU_FEATURES_UNKNOWN 0x80000000
+
+static volatile uint32_t features = CPU_FEATURES_UNKNOWN;
+
+static uint32_t cpu_detect(void)
+{
+    uint32_t detected = 0;
+#ifdef CPU_X86
+    unsigned int eax, ebx, ecx, edx, xcr0_lo, xcr0_hi;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 0;
+
+    if (edx & bit_SSE2)
+        detected |= CPU_FEATURE_SSE2;
+    if (ecx & bit_SSSE3)
+        detected |= CPU_FEATURE_SSSE3;
+    if (ecx & bit_SSE4_1)
+        detected |= CPU_FEATURE_SSE41;
+    if (ecx & bit_AES)
+        detected |= CPU_FEATURE_AES;
+
+    /* AVX2 also needs the OS to save the YMM registers across context switches */
+    if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX)) {
+        __asm__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+        if ((xcr0_lo & 0x6) == 0x6 && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_AVX2))
+            detected |= CPU_FEATURE_AVX2;
+    }
+#endif
+    return detected;
+}
+
+uint32_t cpu_features(void)
+{
+    uint32_t current = features;
+
+    if (current == CPU_FEATURES_UNKNOWN)
+        features = current = cpu_detect();
+    return current;
+}
+
+void cpu_set_features(uint32_t requested)
+{
+    features = cpu_detect() & requested;
+}
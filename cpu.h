@@ -0,0 +1,33 @@
+#ifndef CPU_H
+#define CPU_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CPU_X86 1
+/* lets one function use instructions the rest of the build does not assume */
+#define CPU_TARGET(features) __attribute__((target(features)))
+#endif
+
+/* cpu_features() bits */
+#define CPU_FEATURE_SSE2    0x01
+#define CPU_FEATURE_SSSE3   0x02
+#define CPU_FEATURE_SSE41   0x04
+#define CPU_FEATURE_AES     0x08
+#define CPU_FEATURE_AVX2    0x10    /* only when the OS saves the YMM state */
+
+/* Instruction set extensions of the running CPU, detected on first use. */
+uint32_t cpu_features(void);
+
+/* Restricts the code paths to the given features, e.g. 0 for the portable ones. */
+void cpu_set_features(uint32_t features);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -17,4 +17,4 @@
 
 typedef enum {SUCCESS = 0, FAIL = 1, BAD_HASHLEN = 2} HashReturn;
 
-HashReturn jh_hash(int hashbitlen, const BitSequence *data, DataLength databitlen, BitSequence *hashval);
+HashReturn jh_hash_n(int hashbitlen, const BitSequence *data, DataLength databitlen, BitSequence *hashval);
@@ -532,49 +532,51 @@ static OAES_RET oaes_key_destroy( oaes_key ** key )
 	return OAES_RET_SUCCESS;
 }
 
-static OAES_RET oaes_key_expand( OAES_CTX * ctx )
+OAES_RET oaes_key_expand_data(
+		const uint8_t * data, size_t data_len, uint8_t * exp_data )
 {
 	size_t _i, _j;
-	oaes_ctx * _ctx = (oaes_ctx *) ctx;
+	size_t _key_base = data_len / OAES_RKEY_LEN;
+	size_t _num_keys = _key_base + OAES_ROUND_BASE;
 
-	if( NULL == _ctx )
+	if( NULL == data )
 		return OAES_RET_ARG1;
 
-	if( NULL == _ctx->key )
-		return OAES_RET_NOKEY;
-
-	_ctx->key->key_base = _ctx->key->data_len / OAES_RKEY_LEN;
-	_ctx->key->num_keys =  _ctx->key->key_base + OAES_ROUND_BASE;
-
-	_ctx->key->exp_data_len = _ctx->key->num_keys * OAES_RKEY_LEN * OAES_COL_LEN;
-	_ctx->key->exp_data = (uint8_t *)
-			calloc( _ctx->key->exp_data_len, sizeof( uint8_t ));
+	switch( data_len )
+	{
+		case 16:
+		case 24:
+		case 32:
+			break;
+		default:
+			return OAES_RET_ARG2;
+	}
 
-	if( NULL == _ctx->key->exp_data )
-		return OAES_RET_MEM;
+	if( NULL == exp_data )
+		return OAES_RET_ARG3;
 
-	// the first _ctx->key->data_len are a direct copy
-	memcpy( _ctx->key->exp_data, _ctx->key->data, _ctx->key->data_len );
+	// the first data_len are a direct copy
+	memcpy( exp_data, data, data_len );
 
 	// apply ExpandKey algorithm for remainder
-	for( _i = _ctx->key->key_base; _i < _ctx->key->num_keys * OAES_RKEY_LEN; _i++ )
+	for( _i = _key_base; _i < _num_keys * OAES_RKEY_LEN; _i++ )
 	{
 		uint8_t _temp[OAES_COL_LEN];
 
 		memcpy( _temp,
-				_ctx->key->exp_data + ( _i - 1 ) * OAES_RKEY_LEN, OAES_COL_LEN );
+				exp_data + ( _i - 1 ) * OAES_RKEY_LEN, OAES_COL_LEN );
 
 		// transform key column
-		if( 0 == _i % _ctx->key->key_base )
+		if( 0 == _i % _key_base )
 		{
 			oaes_word_rot_left( _temp );
 
 			for( _j = 0; _j < OAES_COL_LEN; _j++ )
 				oaes_sub_byte( _temp + _j );
 
-			_temp[0] = _temp[0] ^ oaes_gf_8[ _i / _ctx->key->key_base - 1 ];
+			_temp[0] = _temp[0] ^ oaes_gf_8[ _i / _key_base - 1 ];
 		}
-		else if( _ctx->key->key_base > 6 && 4 == _i % _ctx->key->key_base )
+		else if( _key_base > 6 && 4 == _i % _key_base )
 		{
 			for( _j = 0; _j < OAES_COL_LEN; _j++ )
 				oaes_sub_byte( _temp + _j );
@@ -582,8 +584,8 @@ static OAES_RET oaes_key_expand( OAES_CTX * ctx )
 
 		for( _j = 0; _j < OAES_COL_LEN; _j++ )
 		{
-			_ctx->key->exp_data[ _i * OAES_RKEY_LEN + _j ] =
-					_ctx->key->exp_data[ ( _i - _ctx->key->key_base ) *
+			exp_data[ _i * OAES_RKEY_LEN + _j ] =
+					exp_data[ ( _i - _key_base ) *
 					OAES_RKEY_LEN + _j ] ^ _temp[_j];
 		}
 	}
@@ -591,6 +593,30 @@ static OAES_RET oaes_key_expand( OAES_CTX * ctx )
 	return OAES_RET_SUCCESS;
 }
 
+static OAES_RET oaes_key_expand( OAES_CTX * ctx )
+{
+	oaes_ctx * _ctx = (oaes_ctx *) ctx;
+
+	if( NULL == _ctx )
+		return OAES_RET_ARG1;
+
+	if( NULL == _ctx->key )
+		return OAES_RET_NOKEY;
+
+	_ctx->key->key_base = _ctx->key->data_len / OAES_RKEY_LEN;
+	_ctx->key->num_keys =  _ctx->key->key_base + OAES_ROUND_BASE;
+
+	_ctx->key->exp_data_len = _ctx->key->num_keys * OAES_RKEY_LEN * OAES_COL_LEN;
+	_ctx->key->exp_data = (uint8_t *)
+			calloc( _ctx->key->exp_data_len, sizeof( uint8_t ));
+
+	if( NULL == _ctx->key->exp_data )
+		return OAES_RET_MEM;
+
+	return oaes_key_expand_data( _ctx->key->data, _ctx->key->data_len,
+			_ctx->key->exp_data );
+}
+
 static OAES_RET oaes_key_gen( OAES_CTX * ctx, size_t key_size )
 {
 	size_t _i;
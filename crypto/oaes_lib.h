@@ -192,6 +192,11 @@ OAES_API OAES_RET oaes_key_import( OAES_CTX * ctx,
 OAES_API OAES_RET oaes_key_import_data( OAES_CTX * ctx,
 		const uint8_t * data, size_t data_len );
 
+// expand data into round keys without a context or any allocation
+// exp_data must hold ( data_len / 4 + 7 ) * 16 bytes, 240 for a 256-bit key
+OAES_API OAES_RET oaes_key_expand_data(
+		const uint8_t * data, size_t data_len, uint8_t * exp_data );
+
 // set c == NULL to get the required c_len
 OAES_API OAES_RET oaes_encrypt( OAES_CTX * ctx,
 		const uint8_t * m, size_t m_len, uint8_t * c, size_t * c_len );
@@ -2,6 +2,7 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "cryptonight.h"
 #include "crypto/oaes_lib.h"
 #include "crypto/c_keccak.h"
 #include "crypto/c_groestl.h"
@@ -10,6 +11,12 @@
 #include "crypto/c_skein.h"
 #include "crypto/int-util.h"
 #include "crypto/hash-ops.h"
+#include "scratchpad.h"
+#include "cpu.h"
+
+#ifdef CPU_X86
+#include <immintrin.h>
+#endif
 
 #define MEMORY         (1 << 21) /* 2 MiB */
 #define ITER           (1 << 20)
@@ -37,7 +44,7 @@ void do_groestl_hash(const void* input, size_t len, char* output) {
 }
 
 static void do_jh_hash(const void* input, size_t len, char* output) {
-    int r = jh_hash(HASH_SIZE * 8, input, 8 * len, (uint8_t*)output);
+    int r = jh_hash_n(HASH_SIZE * 8, input, 8 * len, (uint8_t*)output);
     assert(SUCCESS == r);
 }
 
@@ -110,30 +117,25 @@ static inline void xor_blocks_dst(const uint8_t* a, const uint8_t* b, uint8_t* d
 }
 
 struct cryptonight_ctx {
-    uint8_t long_state[MEMORY];
+    uint8_t *long_state;
     union cn_slow_hash_state state;
     uint8_t text[INIT_SIZE_BYTE];
     uint8_t a[AES_BLOCK_SIZE];
     uint8_t b[AES_BLOCK_SIZE];
     uint8_t c[AES_BLOCK_SIZE];
-    uint8_t aes_key[AES_KEY_SIZE];
-    oaes_ctx* aes_ctx;
+    uint8_t aes_exp_key[240];  /* AES-256 round keys */
 };
 
-void cryptonight_hash(const char* input, char* output, uint32_t len) {
-    struct cryptonight_ctx *ctx = alloca(sizeof(struct cryptonight_ctx));
-    hash_process(&ctx->state.hs, (const uint8_t*) input, len);
-    memcpy(ctx->text, ctx->state.init, INIT_SIZE_BYTE);
-    memcpy(ctx->aes_key, ctx->state.hs.b, AES_KEY_SIZE);
-    ctx->aes_ctx = (oaes_ctx*) oaes_alloc();
+static void cryptonight_table(struct cryptonight_ctx *ctx) {
     size_t i, j;
 
-    oaes_key_import_data(ctx->aes_ctx, ctx->aes_key, AES_KEY_SIZE);
+    memcpy(ctx->text, ctx->state.init, INIT_SIZE_BYTE);
+    oaes_key_expand_data(ctx->state.hs.b, AES_KEY_SIZE, ctx->aes_exp_key);
     for (i = 0; i < MEMORY / INIT_SIZE_BYTE; i++) {
         for (j = 0; j < INIT_SIZE_BLK; j++) {
             aesb_pseudo_round(&ctx->text[AES_BLOCK_SIZE * j],
                     &ctx->text[AES_BLOCK_SIZE * j],
-                    ctx->aes_ctx->key->exp_data);
+                    ctx->aes_exp_key);
         }
         memcpy(&ctx->long_state[i * INIT_SIZE_BYTE], ctx->text, INIT_SIZE_BYTE);
     }
@@ -159,21 +161,201 @@ void cryptonight_hash(const char* input, char* output, uint32_t len) {
     }
 
     memcpy(ctx->text, ctx->state.init, INIT_SIZE_BYTE);
-    oaes_key_import_data(ctx->aes_ctx, &ctx->state.hs.b[32], AES_KEY_SIZE);
+    oaes_key_expand_data(&ctx->state.hs.b[32], AES_KEY_SIZE, ctx->aes_exp_key);
     for (i = 0; i < MEMORY / INIT_SIZE_BYTE; i++) {
         for (j = 0; j < INIT_SIZE_BLK; j++) {
             xor_blocks(&ctx->text[j * AES_BLOCK_SIZE],
                     &ctx->long_state[i * INIT_SIZE_BYTE + j * AES_BLOCK_SIZE]);
             aesb_pseudo_round(&ctx->text[j * AES_BLOCK_SIZE],
                     &ctx->text[j * AES_BLOCK_SIZE],
-                    ctx->aes_ctx->key->exp_data);
+                    ctx->aes_exp_key);
         }
     }
     memcpy(ctx->state.init, ctx->text, INIT_SIZE_BYTE);
-    hash_permutation(&ctx->state.hs);
-    /*memcpy(hash, &state, 32);*/
-    extra_hashes[ctx->state.hs.b[0] & 3](&ctx->state, 200, output);
-    oaes_free((OAES_CTX **) &ctx->aes_ctx);
+}
+
+#if defined(CPU_X86) && defined(__x86_64__)
+#define CRYPTONIGHT_AESNI
+
+#define AESNI CPU_TARGET("aes,sse2")
+
+AESNI static inline __m128i aesni_key_xor(__m128i k) {
+    k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+    return _mm_xor_si128(k, _mm_slli_si128(k, 8));
+}
+
+/* next two AES-256 round keys from the previous two */
+#define AESNI_EXPAND_KEY(k, n, rcon) do { \
+    k[n] = _mm_xor_si128(aesni_key_xor(k[n - 2]), \
+            _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k[n - 1], rcon), 0xFF)); \
+    k[n + 1] = _mm_xor_si128(aesni_key_xor(k[n - 1]), \
+            _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k[n], 0x00), 0xAA)); \
+} while (0)
+
+/* the ten round keys aesb_pseudo_round uses */
+AESNI static void aesni_expand_key(const uint8_t *key, __m128i *k) {
+    k[0] = _mm_loadu_si128((const __m128i*) key);
+    k[1] = _mm_loadu_si128((const __m128i*) (key + 16));
+    AESNI_EXPAND_KEY(k, 2, 0x01);
+    AESNI_EXPAND_KEY(k, 4, 0x02);
+    AESNI_EXPAND_KEY(k, 6, 0x04);
+    AESNI_EXPAND_KEY(k, 8, 0x08);
+}
+
+/* aesb_pseudo_round on all eight blocks of the text at once */
+AESNI static inline void aesni_pseudo_rounds(__m128i *x, const __m128i *k) {
+    size_t r, j;
+
+    for (r = 0; r < 10; r++)
+        for (j = 0; j < INIT_SIZE_BLK; j++)
+            x[j] = _mm_aesenc_si128(x[j], k[r]);
+}
+
+AESNI static void aesni_explode(struct cryptonight_ctx *ctx) {
+    __m128i k[10], x[INIT_SIZE_BLK];
+    size_t i, j;
+
+    aesni_expand_key(ctx->state.hs.b, k);
+    for (j = 0; j < INIT_SIZE_BLK; j++)
+        x[j] = _mm_loadu_si128((const __m128i*) ctx->state.init + j);
+    for (i = 0; i < MEMORY; i += INIT_SIZE_BYTE) {
+        aesni_pseudo_rounds(x, k);
+        for (j = 0; j < INIT_SIZE_BLK; j++)
+            _mm_store_si128((__m128i*) &ctx->long_state[i] + j, x[j]);
+    }
+}
+
+AESNI static void aesni_implode(struct cryptonight_ctx *ctx) {
+    __m128i k[10], x[INIT_SIZE_BLK];
+    size_t i, j;
+
+    aesni_expand_key(&ctx->state.hs.b[32], k);
+    for (j = 0; j < INIT_SIZE_BLK; j++)
+        x[j] = _mm_loadu_si128((const __m128i*) ctx->state.init + j);
+    for (i = 0; i < MEMORY; i += INIT_SIZE_BYTE) {
+        for (j = 0; j < INIT_SIZE_BLK; j++)
+            x[j] = _mm_xor_si128(x[j], _mm_load_si128((const __m128i*) &ctx->long_state[i] + j));
+        aesni_pseudo_rounds(x, k);
+    }
+    for (j = 0; j < INIT_SIZE_BLK; j++)
+        _mm_storeu_si128((__m128i*) ctx->state.init + j, x[j]);
+}
+
+/*
+ * The main loop of several independent hashes, one step of each in turn so
+ * the core works on one while the others wait for their scratchpad reads.
+ * Always inlined with a constant number of ways to keep the state in registers.
+ */
+AESNI static inline __attribute__((always_inline))
+void aesni_main_loop(struct cryptonight_ctx **ctx, const size_t ways) {
+    __m128i a[CRYPTONIGHT_MAX_WAYS], b[CRYPTONIGHT_MAX_WAYS], c[CRYPTONIGHT_MAX_WAYS];
+    uint64_t a0[CRYPTONIGHT_MAX_WAYS], a1[CRYPTONIGHT_MAX_WAYS];
+    uint64_t *p, hi, lo, d0, d1;
+    unsigned __int128 product;
+    size_t i, w;
+
+    for (w = 0; w < ways; w++) {
+        a[w] = _mm_xor_si128(_mm_loadu_si128((const __m128i*) ctx[w]->state.k),
+                _mm_loadu_si128((const __m128i*) &ctx[w]->state.k[32]));
+        b[w] = _mm_xor_si128(_mm_loadu_si128((const __m128i*) &ctx[w]->state.k[16]),
+                _mm_loadu_si128((const __m128i*) &ctx[w]->state.k[48]));
+        a0[w] = _mm_cvtsi128_si64(a[w]);
+        a1[w] = _mm_cvtsi128_si64(_mm_unpackhi_epi64(a[w], a[w]));
+    }
+
+    for (i = 0; i < ITER / 2; i++) {
+        /* Iteration 1 */
+        for (w = 0; w < ways; w++) {
+            p = (uint64_t*) &ctx[w]->long_state[a0[w] & (MEMORY - AES_BLOCK_SIZE)];
+            c[w] = _mm_aesenc_si128(_mm_load_si128((const __m128i*) p), a[w]);
+            _mm_store_si128((__m128i*) p, _mm_xor_si128(c[w], b[w]));
+        }
+        /* Iteration 2 */
+        for (w = 0; w < ways; w++) {
+            p = (uint64_t*) &ctx[w]->long_state[_mm_cvtsi128_si64(c[w]) & (MEMORY - AES_BLOCK_SIZE)];
+            d0 = p[0];
+            d1 = p[1];
+            product = (unsigned __int128) (uint64_t) _mm_cvtsi128_si64(c[w]) * d0;
+            hi = (uint64_t) (product >> 64) + a0[w];
+            lo = (uint64_t) product + a1[w];
+            p[0] = hi;
+            p[1] = lo;
+            a0[w] = d0 ^ hi;
+            a1[w] = d1 ^ lo;
+            a[w] = _mm_set_epi64x(a1[w], a0[w]);
+            b[w] = c[w];
+        }
+    }
+}
+
+AESNI static void cryptonight_aesni(struct cryptonight_ctx **ctx, size_t ways) {
+    size_t w;
+
+    for (w = 0; w < ways; w++)
+        aesni_explode(ctx[w]);
+
+    switch (ways) {
+    case 4:
+        aesni_main_loop(ctx, 4);
+        break;
+    case 2:
+        aesni_main_loop(ctx, 2);
+        break;
+    default:
+        aesni_main_loop(ctx, 1);
+        break;
+    }
+
+    for (w = 0; w < ways; w++)
+        aesni_implode(ctx[w]);
+}
+#endif
+
+/* ways independent hashes sharing one scratchpad acquisition */
+static void cryptonight_ways(const char* const* input, char* const* output, const uint32_t* len, size_t ways) {
+    struct cryptonight_ctx context[CRYPTONIGHT_MAX_WAYS], *ctx[CRYPTONIGHT_MAX_WAYS];
+    uint8_t *long_state = scratchpad_acquire(ways * MEMORY);
+    size_t w;
+
+    if (long_state == NULL) {
+        for (w = 0; w < ways; w++)
+            memset(output[w], 0, HASH_SIZE);
+        return;
+    }
+
+    for (w = 0; w < ways; w++) {
+        ctx[w] = &context[w];
+        /* exactly one 2 MiB huge page each when those are enabled */
+        ctx[w]->long_state = long_state + w * MEMORY;
+        hash_process(&ctx[w]->state.hs, (const uint8_t*) input[w], len[w]);
+    }
+
+#ifdef CRYPTONIGHT_AESNI
+    if (cpu_features() & CPU_FEATURE_AES)
+        cryptonight_aesni(ctx, ways);
+    else
+#endif
+    for (w = 0; w < ways; w++)
+        cryptonight_table(ctx[w]);
+
+    for (w = 0; w < ways; w++) {
+        hash_permutation(&ctx[w]->state.hs);
+        extra_hashes[ctx[w]->state.hs.b[0] & 3](&ctx[w]->state, 200, output[w]);
+    }
+    scratchpad_release(long_state);
+}
+
+void cryptonight_hash(const char* input, char* output, uint32_t len) {
+    cryptonight_ways(&input, &output, &len, 1);
+}
+
+void cryptonight_multi_hash(const char* const* input, char* const* output, const uint32_t* len, uint32_t count) {
+    uint32_t ways;
+
+    for (; count > 0; input += ways, output += ways, len += ways, count -= ways) {
+        ways = count >= 4 ? 4 : count >= 2 ? 2 : 1;
+        cryptonight_ways(input, output, len, ways);
+    }
 }
 
 void cryptonight_fast_hash(const char* input, char* output, uint32_t len) {
@@ -8,6 +8,10 @@ extern "C" {
 #include <stdint.h>
 
 void cryptonight_hash(const char* input, char* output, uint32_t len);
+
+/* Hashes count independent inputs, interleaving them 4 or 2 at a time. */
+#define CRYPTONIGHT_MAX_WAYS 4
+void cryptonight_multi_hash(const char* const* input, char* const* output, const uint32_t* len, uint32_t count);
 void cryptonight_fast_hash(const char* input, char* output, uint32_t len);
 
 #ifdef __cplusplus
@@ -130,23 +130,28 @@ unsigned char mix_hashed_num(unsigned char * hashedData, unsigned char * ret_lis
 
 
 void dcrypt_hash(const char * input, char * hash, uint32_t len) {
-  unsigned char * instr = malloc(len);
+  // sha256() pads its input in place and writes 64 nibbles, so every buffer it touches needs slack
+  unsigned char * instr = malloc(len + 128);
   memcpy( instr, input, len );
   unsigned char * hashed = malloc(128);
   unsigned char * mixedHash = malloc(1048576 + 1024); // This assumes a max length of work of 1024 bytes?;
   unsigned char * finalToHash;
+  unsigned char finalHash[64];
   unsigned int lenMixedHash = 0;
   sha256(instr, hashed, len); 
   if (mix_hashed_num(hashed, mixedHash, &lenMixedHash) == true) {
-    finalToHash = malloc( lenMixedHash + len + 64 );
+    finalToHash = malloc( lenMixedHash + len + 128 );
     memcpy( finalToHash, mixedHash, lenMixedHash);
     memcpy( &(finalToHash[lenMixedHash]), instr, len);
-    sha256(finalToHash, hash, len + lenMixedHash);
+    sha256(finalToHash, finalHash, len + lenMixedHash);
+    memcpy(hash, finalHash, 32);
     free(finalToHash);
   } else {
     printf("Buffer limit exceeded.\n");
   }
   free(mixedHash);
+  free(hashed);
+  free(instr);
 }
 
 /* :int main(int argc, char *argv[])
@@ -6,13 +6,12 @@
 
 #include "sha3/sph_shavite.h"
 #include "sha3/sph_simd.h"
-#include "sha3/sph_echo.h"
+#include "sha3/echo_aesni.h"
 
 void fresh_hash(const char* input, char* output, uint32_t len)
 {
     sph_shavite512_context	ctx_shavite1;
     sph_simd512_context		ctx_simd1;
-    sph_echo512_context		ctx_echo1;
 
     //these uint512 in the c++ source of the client are backed by an array of uint32
     uint32_t hashA[16], hashB[16];
@@ -33,9 +32,7 @@ void fresh_hash(const char* input, char* output, uint32_t len)
     sph_simd512 (&ctx_simd1, hashA, 64);
     sph_simd512_close(&ctx_simd1, hashB);
 
-    sph_echo512_init (&ctx_echo1);
-    sph_echo512 (&ctx_echo1, hashB, 64);
-    sph_echo512_close(&ctx_echo1, hashA);
+    echo512_64(hashB, hashA);
 
     memcpy(output, hashA, 32);
 
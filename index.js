@@ -1 +1,28 @@
-module.exports = require('bindings')('multihashing.node')
\ No newline at end of file
+var multiHashing = require('bindings')('multihashing.node');
+
+// Async natives take a trailing (err, hash) callback; without one they return a Promise.
+Object.keys(multiHashing).forEach(function(name) {
+    if (!/Async$/.test(name))
+        return;
+
+    var fn = multiHashing[name];
+
+    multiHashing[name] = function() {
+        var args = Array.prototype.slice.call(arguments);
+
+        if (typeof args[args.length - 1] === 'function')
+            return fn.apply(null, args);
+
+        return new Promise(function(resolve, reject) {
+            args.push(function(err, result) {
+                if (err)
+                    reject(err);
+                else
+                    resolve(result);
+            });
+            fn.apply(null, args);
+        });
+    };
+});
+
+module.exports = multiHashing;
@@ -2,7 +2,14 @@
 #include <node_buffer.h>
 #include <v8.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <uv.h>
 #include "nan.h"
+#include "workpool.h"
 
 extern "C" {
     #include "bcrypt.h"
@@ -38,12 +45,17 @@ extern "C" {
     #include "fresh.h"
     #include "zr5.h"
     #include "Lyra2RE.h"
+    #include "algorithms.h"
+    #include "scratchpad.h"
 }
 
 #include "boolberry.h"
 
 #define THROW_ERROR_EXCEPTION(x) Nan::ThrowError(x)
 
+/* reported when scratchpad_failed() says a hash could not get its memory */
+#define SCRATCHPAD_ERROR "Could not allocate the scratchpad."
+
 using namespace node;
 using namespace v8;
 
@@ -100,9 +112,7 @@ NAN_METHOD(x5) {
     char * input = Buffer::Data(target);
     char *output = (char*) malloc(sizeof(char) * 32);
 
-    uint32_t input_len = Buffer::Length(target);
-
-    x11_hash(input, output, input_len);
+    x5_hash(input, output);
 
     info.GetReturnValue().Set(Nan::NewBuffer(output, 32).ToLocalChecked());
 }
@@ -128,6 +138,11 @@ NAN_METHOD(scrypt) {
 
    scrypt_N_R_1_256(input, output, nValue, rValue, input_len);
 
+   if (scratchpad_failed()) {
+       free(output);
+       return THROW_ERROR_EXCEPTION(SCRATCHPAD_ERROR);
+   }
+
    info.GetReturnValue().Set(Nan::NewBuffer(output, 32).ToLocalChecked());
 }
 
@@ -148,11 +163,19 @@ NAN_METHOD(neoscrypt) {
     Local<Number> numn = Nan::To<Number>(info[1]).ToLocalChecked();
     unsigned int nProfile = numn->Value();
 
+    if (!neoscrypt_profile_supported(nProfile))
+        return THROW_ERROR_EXCEPTION("Unsupported neoscrypt profile.");
+
     unsigned char *input = (unsigned char *) Buffer::Data(target);
     char *output = (char*) malloc(sizeof(char) * 32);
 
     neoscrypt(input, (unsigned char *) output, nProfile);
 
+    if (scratchpad_failed()) {
+        free(output);
+        return THROW_ERROR_EXCEPTION(SCRATCHPAD_ERROR);
+    }
+
     info.GetReturnValue().Set(Nan::NewBuffer(output, 32).ToLocalChecked());
 }
 
@@ -179,6 +202,11 @@ NAN_METHOD(scryptn) {
 
    scrypt_N_R_1_256(input, output, N, 1, input_len); //hardcode for now to R=1 for now
 
+   if (scratchpad_failed()) {
+       free(output);
+       return THROW_ERROR_EXCEPTION(SCRATCHPAD_ERROR);
+   }
+
    info.GetReturnValue().Set(Nan::NewBuffer(output, 32).ToLocalChecked());
 }
 
@@ -489,6 +517,11 @@ NAN_METHOD(cryptonight) {
     else
         cryptonight_hash(input, output, input_len);
 
+    if (scratchpad_failed()) {
+        free(output);
+        return THROW_ERROR_EXCEPTION(SCRATCHPAD_ERROR);
+    }
+
     info.GetReturnValue().Set(Nan::NewBuffer(output, 32).ToLocalChecked());
 }
 
@@ -522,11 +555,14 @@ NAN_METHOD(x14) {
     if(!Buffer::HasInstance(target))
         return THROW_ERROR_EXCEPTION("Argument should be a buffer object.");
 
+    uint32_t input_len = Buffer::Length(target);
+
+    if(input_len < 80)
+        return THROW_ERROR_EXCEPTION("Buffer length should be at least 80 bytes.");
+
     char * input = Buffer::Data(target);
     char *output = (char*) malloc(sizeof(char) * 32);
 
-    uint32_t input_len = Buffer::Length(target);
-
     x14_hash(input, output, input_len);
 
     info.GetReturnValue().Set(Nan::NewBuffer(output, 32).ToLocalChecked());
@@ -698,6 +734,11 @@ NAN_METHOD(lyra2re) {
 
     lyra2re_hash(input, output);
 
+    if (scratchpad_failed()) {
+        free(output);
+        return THROW_ERROR_EXCEPTION(SCRATCHPAD_ERROR);
+    }
+
    info.GetReturnValue().Set(Nan::NewBuffer(output, 32).ToLocalChecked());
 }
 
@@ -715,6 +756,11 @@ NAN_METHOD(lyra2re2) {
 
     lyra2re2_hash(input, output);
 
+    if (scratchpad_failed()) {
+        free(output);
+        return THROW_ERROR_EXCEPTION(SCRATCHPAD_ERROR);
+    }
+
    info.GetReturnValue().Set(Nan::NewBuffer(output, 32).ToLocalChecked());
 }
 
@@ -769,17 +815,1488 @@ NAN_METHOD(c11) {
     if(!Buffer::HasInstance(target))
         return THROW_ERROR_EXCEPTION("Argument should be a buffer object.");
 
+    uint32_t input_len = Buffer::Length(target);
+
+    if(input_len < 80)
+        return THROW_ERROR_EXCEPTION("Buffer length should be at least 80 bytes.");
+
     char * input = Buffer::Data(target);
     char *output = (char*) malloc(sizeof(char) * 32);
 
-    uint32_t input_len = Buffer::Length(target);
-
     c11_hash(input, output);
 
     info.GetReturnValue().Set(Nan::NewBuffer(output, 32).ToLocalChecked());
 }
 
+/*
+ * Generic entry points over the algorithm registry in algorithms.h. An
+ * algorithm is given either by its numeric id from listAlgorithms() or by
+ * name, and its params (if any) follow the input, defaulting to the
+ * registry's.
+ */
+
+static uv_mutex_t serial_lock;
+
+static const algorithm_t *GetAlgorithm(Local<Value> value) {
+    if (value->IsUint32()) {
+        uint32_t id = Nan::To<uint32_t>(value).FromJust();
+        return id < ALGO_COUNT ? &algorithms[id] : NULL;
+    }
+
+    if (!value->IsString())
+        return NULL;
+
+    Nan::Utf8String name(value);
+
+    return *name ? algorithm_find(*name) : NULL;
+}
+
+/*
+ * Reads the algorithm's params from info[first], info[first + 1], ... up to
+ * the first argument that is not a number, so a trailing callback is never
+ * mistaken for one. Returns an error message or NULL.
+ */
+static const char *GetParams(Nan::NAN_METHOD_ARGS_TYPE info, int first, const algorithm_t *algo, algorithm_params &params) {
+    params = algo->defaults;
+
+    if (algo->param_count > 0 && first < info.Length() && info[first]->IsNumber())
+        params.n = Nan::To<uint32_t>(info[first]).FromJust();
+
+    if (algo->param_count > 1 && first + 1 < info.Length() && info[first + 1]->IsNumber())
+        params.r = Nan::To<uint32_t>(info[first + 1]).FromJust();
+
+    if (algo == &algorithms[ALGO_SCRYPT] && (params.n < 2 || (params.n & (params.n - 1)) != 0 || params.r == 0))
+        return "N should be a power of 2 greater than 1 and R should be positive.";
+
+    if (algo == &algorithms[ALGO_SCRYPTN] && (params.n < 1 || params.n > 30))
+        return "N factor should be between 1 and 30.";
+
+    if (algo == &algorithms[ALGO_NEOSCRYPT] && !neoscrypt_profile_supported(params.n))
+        return "Unsupported neoscrypt profile.";
+
+    return NULL;
+}
+
+static const char *CheckInput(const algorithm_t *algo, size_t len) {
+    if (len < algo->input_len)
+        return "Buffer is shorter than the algorithm's input length.";
+
+    return NULL;
+}
+
+/*
+ * Hashes with the registry entry, serializing algorithms that are not
+ * thread-safe. Returns an error message or NULL.
+ */
+static const char *RunAlgorithm(const algorithm_t *algo, const char *input, char *output, uint32_t len, const algorithm_params &params) {
+    if (algo->flags & ALGORITHM_THREAD_SAFE) {
+        algo->hash(input, output, len, &params);
+    } else {
+        uv_mutex_lock(&serial_lock);
+        algo->hash(input, output, len, &params);
+        uv_mutex_unlock(&serial_lock);
+    }
+
+    return scratchpad_failed() ? SCRATCHPAD_ERROR : NULL;
+}
+
+static const char *RunAlgorithmMulti(const algorithm_t *algo, const char *const *inputs, char *const *outputs, const uint32_t *lens, uint32_t count, const algorithm_params &params) {
+    if (algo->flags & ALGORITHM_THREAD_SAFE) {
+        algo->hash_multi(inputs, outputs, lens, count, &params);
+    } else {
+        uv_mutex_lock(&serial_lock);
+        algo->hash_multi(inputs, outputs, lens, count, &params);
+        uv_mutex_unlock(&serial_lock);
+    }
+
+    return scratchpad_failed() ? SCRATCHPAD_ERROR : NULL;
+}
+
+NAN_METHOD(hash) {
+    if (info.Length() < 2)
+        return THROW_ERROR_EXCEPTION("You must provide an algorithm and a buffer to hash.");
+
+    const algorithm_t *algo = GetAlgorithm(info[0]);
+
+    if(algo == NULL)
+        return THROW_ERROR_EXCEPTION("Unknown algorithm.");
+
+    if(!Buffer::HasInstance(info[1]))
+        return THROW_ERROR_EXCEPTION("Argument 2 should be a buffer object.");
+
+    algorithm_params params;
+    const char *err = GetParams(info, 2, algo, params);
+
+    if(err == NULL)
+        err = CheckInput(algo, Buffer::Length(info[1]));
+
+    if(err != NULL)
+        return THROW_ERROR_EXCEPTION(err);
+
+    char *output = (char*) malloc(sizeof(char) * algo->output_len);
+
+    if((err = RunAlgorithm(algo, Buffer::Data(info[1]), output, Buffer::Length(info[1]), params)) != NULL) {
+        free(output);
+        return THROW_ERROR_EXCEPTION(err);
+    }
+
+    info.GetReturnValue().Set(Nan::NewBuffer(output, algo->output_len).ToLocalChecked());
+}
+
+NAN_METHOD(listAlgorithms) {
+    Local<Array> list = Nan::New<Array>(ALGO_COUNT);
+
+    for (uint32_t i = 0; i < ALGO_COUNT; i++) {
+        const algorithm_t *algo = &algorithms[i];
+        Local<Object> entry = Nan::New<Object>();
+
+        Nan::Set(entry, Nan::New("id").ToLocalChecked(), Nan::New<Uint32>(i));
+        Nan::Set(entry, Nan::New("name").ToLocalChecked(), Nan::New(algo->name).ToLocalChecked());
+        Nan::Set(entry, Nan::New("inputLength").ToLocalChecked(), Nan::New<Uint32>(algo->input_len));
+        Nan::Set(entry, Nan::New("outputLength").ToLocalChecked(), Nan::New<Uint32>(algo->output_len));
+        Nan::Set(entry, Nan::New("params").ToLocalChecked(), Nan::New<Uint32>(algo->param_count));
+        Nan::Set(entry, Nan::New("memoryCost").ToLocalChecked(), Nan::New<Number>(algo->memory));
+        Nan::Set(entry, Nan::New("threadSafe").ToLocalChecked(), Nan::New<Boolean>((algo->flags & ALGORITHM_THREAD_SAFE) != 0));
+        Nan::Set(entry, Nan::New("memoryHard").ToLocalChecked(), Nan::New<Boolean>((algo->flags & ALGORITHM_MEMORY_HARD) != 0));
+        Nan::Set(entry, Nan::New("lanes").ToLocalChecked(), Nan::New<Uint32>(algo->hash_multi != NULL ? algo->lanes : 1));
+        Nan::Set(entry, Nan::New("midstate").ToLocalChecked(), Nan::New<Boolean>(algo->prepare != NULL));
+        Nan::Set(list, i, entry);
+    }
+
+    info.GetReturnValue().Set(list);
+}
+
+/*
+ * Memory-hard hashes keep their scratchpad per thread between calls, see
+ * scratchpad.h. trimScratchpads() hands that memory back to the system.
+ */
+
+NAN_METHOD(trimScratchpads) {
+    scratchpad_trim();
+}
+
+NAN_METHOD(setHugePages) {
+    if (info.Length() < 1)
+        return THROW_ERROR_EXCEPTION("You must provide one argument.");
+
+    scratchpad_set_huge_pages(Nan::To<bool>(info[0]).FromJust());
+}
+
+NAN_METHOD(scratchpadStats) {
+    scratchpad_stats_t stats;
+    Local<Object> result = Nan::New<Object>();
+
+    scratchpad_stats(&stats);
+    Nan::Set(result, Nan::New("threads").ToLocalChecked(), Nan::New<Number>(stats.threads));
+    Nan::Set(result, Nan::New("reserved").ToLocalChecked(), Nan::New<Number>(stats.reserved));
+    Nan::Set(result, Nan::New("inUse").ToLocalChecked(), Nan::New<Number>(stats.in_use));
+    Nan::Set(result, Nan::New("hugePagesEnabled").ToLocalChecked(), Nan::New<Boolean>(scratchpad_huge_pages() != 0));
+    Nan::Set(result, Nan::New("hugePages").ToLocalChecked(), Nan::New<Number>(stats.huge_pages));
+    Nan::Set(result, Nan::New("transparentHugePages").ToLocalChecked(), Nan::New<Number>(stats.transparent_huge_pages));
+
+    info.GetReturnValue().Set(result);
+}
+
+/*
+ * Async and batch hashing run on the addon's own WorkPools rather than the
+ * libuv threadpool. Algorithms are split into worker groups by the registry's
+ * cost class, each with its own threads and queues, so a flood of memory-hard
+ * shares cannot hold up the cheap ones. Each group starts with one thread per
+ * physical core, and setWorkerThreads(n[, group]) resizes them at any time.
+ * setMemoryBudget(bytes) caps the scratchpad memory of the hashes running in
+ * both groups together.
+ */
+
+enum worker_group {
+    GROUP_LIGHT,
+    GROUP_HARD,
+    GROUP_COUNT
+};
+
+static const char *group_names[GROUP_COUNT] = { "light", "hard" };
+static WorkPool *pools[GROUP_COUNT];
+static size_t group_threads[GROUP_COUNT];   /* 0 for one per physical core */
+static MemoryBudget memory_budget;
+
+static int AlgorithmGroup(const algorithm_t *algo) {
+    return (algo->flags & ALGORITHM_MEMORY_HARD) ? GROUP_HARD : GROUP_LIGHT;
+}
+
+static WorkPool *GetPool(int group) {
+    if (pools[group] == NULL)
+        pools[group] = new WorkPool(uv_default_loop(), group_threads[group] ? group_threads[group] : WorkPool::PhysicalCores(), &memory_budget);
+
+    return pools[group];
+}
+
+static WorkPool *GetPool(const algorithm_t *algo) {
+    return GetPool(AlgorithmGroup(algo));
+}
+
+/* false unless value is a number that fits a size_t, so NaN, Infinity and negatives are rejected */
+static bool GetSize(Local<Value> value, size_t &size) {
+    if (!value->IsNumber())
+        return false;
+
+    double number = Nan::To<double>(value).FromJust();
+
+    // written so that NaN fails too; SIZE_MAX + 1 is exact as a double
+    if (!(number >= 0 && number < (double)SIZE_MAX + 1.0))
+        return false;
+
+    size = (size_t)number;
+    return true;
+}
+
+NAN_METHOD(setWorkerThreads) {
+    if (info.Length() < 1 || !info[0]->IsUint32() || Nan::To<uint32_t>(info[0]).FromJust() == 0)
+        return THROW_ERROR_EXCEPTION("Argument 1 should be a positive integer.");
+
+    uint32_t threads = Nan::To<uint32_t>(info[0]).FromJust();
+    int group = -1;
+
+    if (info.Length() >= 2 && !info[1]->IsUndefined()) {
+        Nan::Utf8String name(info[1]);
+
+        for (int i = 0; i < GROUP_COUNT; i++) {
+            if (info[1]->IsString() && strcmp(*name, group_names[i]) == 0)
+                group = i;
+        }
+
+        if (group < 0)
+            return THROW_ERROR_EXCEPTION("Argument 2 should be 'light' or 'hard'.");
+    }
+
+    for (int i = 0; i < GROUP_COUNT; i++) {
+        if (group >= 0 && group != i)
+            continue;
+
+        group_threads[i] = threads;
+        if (pools[i] != NULL)
+            pools[i]->Resize(threads);
+    }
+}
+
+NAN_METHOD(setMemoryBudget) {
+    size_t bytes;
+
+    if (info.Length() < 1 || !GetSize(info[0], bytes))
+        return THROW_ERROR_EXCEPTION("Argument 1 should be a number of bytes.");
+
+    memory_budget.SetLimit(bytes);
+}
+
+NAN_METHOD(workerThreads) {
+    Local<Object> result = Nan::New<Object>();
+
+    for (int i = 0; i < GROUP_COUNT; i++) {
+        size_t threads = pools[i] != NULL ? pools[i]->Size() : group_threads[i] ? group_threads[i] : WorkPool::PhysicalCores();
+
+        Nan::Set(result, Nan::New(group_names[i]).ToLocalChecked(), Nan::New<Number>(threads));
+    }
+
+    info.GetReturnValue().Set(result);
+}
+
+/*
+ * Admission control. Queued and running async hashes count against the limits
+ * of their algorithm and against the global ones, in hashes and in the
+ * scratchpad bytes they need (algorithm_memory() each). A call that would go
+ * over a limit is not queued: it returns false and calls back with a "Queue
+ * is full." error, and wouldBlock() tells ahead of time. 0 means no limit.
+ * boolberry is not in the registry and hashes in the caller's scratchpad, so
+ * it only counts as an item against the global limits.
+ * Everything here runs on the loop thread.
+ */
+
+struct QueueUsage {
+    size_t items;
+    size_t bytes;
+};
+
+static QueueUsage queue_usage, algorithm_usage[ALGO_COUNT];
+static QueueUsage queue_limit, algorithm_limit[ALGO_COUNT];
+
+static bool OverLimit(const QueueUsage &usage, const QueueUsage &limit, size_t items, size_t bytes) {
+    return (limit.items != 0 && usage.items + items > limit.items) ||
+        (limit.bytes != 0 && usage.bytes + bytes > limit.bytes);
+}
+
+static bool WouldBlock(const algorithm_t *algo, const algorithm_params &params, size_t items) {
+    size_t bytes = algorithm_memory(algo, &params) * items;
+
+    return OverLimit(queue_usage, queue_limit, items, bytes) ||
+        OverLimit(algorithm_usage[algo - algorithms], algorithm_limit[algo - algorithms], items, bytes);
+}
+
+static bool WouldBlock(size_t items) {
+    return OverLimit(queue_usage, queue_limit, items, 0);
+}
+
+/*
+ * Holds an admitted call's share of the usage until it is released, just
+ * before the callback runs so the callback may queue more work right away.
+ */
+class QueueTicket {
+public:
+    QueueTicket(const algorithm_t *algo, const algorithm_params &params, size_t items)
+        : algo(algo), items(items), bytes(algorithm_memory(algo, &params) * items) {
+        queue_usage.items += items;
+        queue_usage.bytes += bytes;
+        algorithm_usage[algo - algorithms].items += items;
+        algorithm_usage[algo - algorithms].bytes += bytes;
+    }
+
+    // global limits only, see WouldBlock(items)
+    explicit QueueTicket(size_t items)
+        : algo(NULL), items(items), bytes(0) {
+        queue_usage.items += items;
+    }
+
+    ~QueueTicket() {
+        Release();
+    }
+
+    void Release() {
+        queue_usage.items -= items;
+        queue_usage.bytes -= bytes;
+        if (algo != NULL) {
+            algorithm_usage[algo - algorithms].items -= items;
+            algorithm_usage[algo - algorithms].bytes -= bytes;
+        }
+        items = bytes = 0;
+    }
+
+private:
+    QueueTicket(const QueueTicket&);
+    QueueTicket &operator=(const QueueTicket&);
+
+    const algorithm_t *algo;
+    size_t items;
+    size_t bytes;
+};
+
+/* Only calls back with the error it was created with. */
+class RejectedWorker : public PoolWorker {
+public:
+    RejectedWorker(Nan::Callback *callback, const char *message)
+        : PoolWorker(callback) {
+        Fail(message);
+    }
+
+    void Execute() {
+    }
+};
+
+static void Reject(Nan::NAN_METHOD_ARGS_TYPE info, WorkPool *pool, Nan::Callback *callback) {
+    pool->Queue(new RejectedWorker(callback, "Queue is full."));
+    info.GetReturnValue().Set(Nan::False());
+}
+
+static void Reject(Nan::NAN_METHOD_ARGS_TYPE info, const algorithm_t *algo, Nan::Callback *callback) {
+    Reject(info, GetPool(algo), callback);
+}
+
+static const char *GetLimit(Local<Value> value, QueueUsage &limit) {
+    if (!value->IsObject())
+        return "Limits should be an object.";
+
+    Local<Object> object = value.As<Object>();
+    Local<Value> items = Nan::Get(object, Nan::New("items").ToLocalChecked()).ToLocalChecked();
+    Local<Value> bytes = Nan::Get(object, Nan::New("bytes").ToLocalChecked()).ToLocalChecked();
+
+    limit.items = 0;
+    limit.bytes = 0;
+
+    if ((!items->IsUndefined() && !GetSize(items, limit.items)) || (!bytes->IsUndefined() && !GetSize(bytes, limit.bytes)))
+        return "Limits items and bytes should be non-negative numbers.";
+
+    return NULL;
+}
+
+/* setQueueLimits({ items, bytes }) or setQueueLimits(algo, { items, bytes }) */
+NAN_METHOD(setQueueLimits) {
+    if (info.Length() < 1)
+        return THROW_ERROR_EXCEPTION("You must provide the limits.");
+
+    QueueUsage limit;
+    const char *err;
+
+    if (info.Length() < 2) {
+        if ((err = GetLimit(info[0], limit)) != NULL)
+            return THROW_ERROR_EXCEPTION(err);
+        queue_limit = limit;
+        return;
+    }
+
+    const algorithm_t *algo = GetAlgorithm(info[0]);
+
+    if(algo == NULL)
+        return THROW_ERROR_EXCEPTION("Unknown algorithm.");
+
+    if ((err = GetLimit(info[1], limit)) != NULL)
+        return THROW_ERROR_EXCEPTION(err);
+
+    algorithm_limit[algo - algorithms] = limit;
+}
+
+/* wouldBlock(algo[, count[, ...params]]) */
+NAN_METHOD(wouldBlock) {
+    if (info.Length() < 1)
+        return THROW_ERROR_EXCEPTION("You must provide an algorithm.");
+
+    const algorithm_t *algo = GetAlgorithm(info[0]);
+
+    if(algo == NULL)
+        return THROW_ERROR_EXCEPTION("Unknown algorithm.");
+
+    uint32_t count = 1;
+
+    if (info.Length() >= 2 && !info[1]->IsUndefined()) {
+        if (!info[1]->IsUint32())
+            return THROW_ERROR_EXCEPTION("Argument 2 should be an unsigned integer.");
+        count = Nan::To<uint32_t>(info[1]).FromJust();
+    }
+
+    algorithm_params params;
+    const char *err = GetParams(info, 2, algo, params);
+
+    if(err != NULL)
+        return THROW_ERROR_EXCEPTION(err);
+
+    info.GetReturnValue().Set(Nan::New<Boolean>(WouldBlock(algo, params, count)));
+}
+
+NAN_METHOD(queueStats) {
+    Local<Object> result = Nan::New<Object>();
+    Local<Object> per_algorithm = Nan::New<Object>();
+
+    for (uint32_t i = 0; i < ALGO_COUNT; i++) {
+        if (algorithm_usage[i].items == 0)
+            continue;
+
+        Local<Object> entry = Nan::New<Object>();
+
+        Nan::Set(entry, Nan::New("items").ToLocalChecked(), Nan::New<Number>(algorithm_usage[i].items));
+        Nan::Set(entry, Nan::New("bytes").ToLocalChecked(), Nan::New<Number>(algorithm_usage[i].bytes));
+        Nan::Set(per_algorithm, Nan::New(algorithms[i].name).ToLocalChecked(), entry);
+    }
+
+    Nan::Set(result, Nan::New("items").ToLocalChecked(), Nan::New<Number>(queue_usage.items));
+    Nan::Set(result, Nan::New("bytes").ToLocalChecked(), Nan::New<Number>(queue_usage.bytes));
+    Nan::Set(result, Nan::New("algorithms").ToLocalChecked(), per_algorithm);
+    Nan::Set(result, Nan::New("memoryBudget").ToLocalChecked(), Nan::New<Number>(memory_budget.Limit()));
+    Nan::Set(result, Nan::New("runningBytes").ToLocalChecked(), Nan::New<Number>(memory_budget.Used()));
+
+    info.GetReturnValue().Set(result);
+}
+
+/*
+ * Async variants. Each xxxAsync(..., callback) copies its input, runs the
+ * same C hash on the worker pool and calls back with (err, Buffer).
+ */
+
+class HashWorker : public PoolWorker {
+public:
+    HashWorker(Nan::Callback *callback, Local<Object> target)
+        : PoolWorker(callback),
+          input(Buffer::Data(target), Buffer::Data(target) + Buffer::Length(target)) {
+    }
+
+    void HandleOKCallback() {
+        Nan::HandleScope scope;
+
+        Local<Value> argv[] = {
+            Nan::Null(),
+            Nan::CopyBuffer(output, 32).ToLocalChecked()
+        };
+
+        callback->Call(2, argv);
+    }
+
+protected:
+    const char *Input() const { return input.empty() ? NULL : &input[0]; }
+    uint32_t InputLength() const { return input.size(); }
+
+    std::vector<char> input;
+    char output[32];
+};
+
+class AlgorithmWorker : public HashWorker {
+public:
+    AlgorithmWorker(Nan::Callback *callback, Local<Object> target, const algorithm_t *algo, const algorithm_params &params)
+        : HashWorker(callback, target), algo(algo), params(params), ticket(algo, params, 1) {
+        memory = algorithm_memory(algo, &params);
+    }
+
+    void Execute() {
+        const char *err = RunAlgorithm(algo, Input(), output, InputLength(), params);
+
+        if (err != NULL)
+            Fail(err);
+    }
+
+    void WorkComplete() {
+        ticket.Release();
+        HashWorker::WorkComplete();
+    }
+
+private:
+    const algorithm_t *algo;
+    algorithm_params params;
+    QueueTicket ticket;
+};
+
+class BoolberryWorker : public HashWorker {
+public:
+    BoolberryWorker(Nan::Callback *callback, Local<Object> target, Local<Object> target_spad, uint32_t height)
+        : HashWorker(callback, target),
+          scratchpad(Buffer::Data(target_spad)), spad_len(Buffer::Length(target_spad)), height(height), ticket(1) {
+        // the scratchpad can be hundreds of megabytes, so keep it alive instead of copying it
+        SaveToPersistent("scratchpad", target_spad);
+    }
+
+    void Execute() {
+        boolberry_hash(Input(), InputLength(), scratchpad, spad_len, output, height);
+    }
+
+    void WorkComplete() {
+        ticket.Release();
+        HashWorker::WorkComplete();
+    }
+
+private:
+    const char *scratchpad;
+    uint64_t spad_len;
+    uint32_t height;
+    QueueTicket ticket;
+};
+
+/* The callback is always the last argument of an async call. */
+static Nan::Callback *GetCallback(Nan::NAN_METHOD_ARGS_TYPE info) {
+    if (info.Length() < 1 || !info[info.Length() - 1]->IsFunction())
+        return NULL;
+
+    return new Nan::Callback(info[info.Length() - 1].As<Function>());
+}
+
+/*
+ * Async calls take an optional options object right before the callback.
+ * { epoch: n } tags the work so cancelEpoch(n) drops it while it is queued,
+ * e.g. the shares of a job that went stale with a new block, and
+ * { priority: 'high' } runs it ahead of all 'normal' (the default) work.
+ */
+
+static bool IsOptions(Local<Value> value) {
+    return value->IsObject() && !value->IsFunction() && !value->IsArray() && !Buffer::HasInstance(value);
+}
+
+static const char *GetOptions(Nan::NAN_METHOD_ARGS_TYPE info, WorkOptions &options) {
+    options = WorkOptions();
+
+    if (info.Length() < 2 || !IsOptions(info[info.Length() - 2]))
+        return NULL;
+
+    Local<Object> object = info[info.Length() - 2].As<Object>();
+    Local<Value> epoch = Nan::Get(object, Nan::New("epoch").ToLocalChecked()).ToLocalChecked();
+    Local<Value> priority = Nan::Get(object, Nan::New("priority").ToLocalChecked()).ToLocalChecked();
+
+    if (!epoch->IsUndefined()) {
+        if (!epoch->IsUint32())
+            return "Option epoch should be an unsigned integer.";
+        options.epoch = Nan::To<uint32_t>(epoch).FromJust();
+        options.has_epoch = true;
+    }
+
+    if (!priority->IsUndefined()) {
+        Nan::Utf8String name(priority);
+
+        if (!priority->IsString() || (strcmp(*name, "high") != 0 && strcmp(*name, "normal") != 0))
+            return "Option priority should be 'high' or 'normal'.";
+        options.priority = strcmp(*name, "high") == 0 ? WORK_PRIORITY_HIGH : WORK_PRIORITY_NORMAL;
+    }
+
+    return NULL;
+}
+
+/*
+ * Micro-batching. Async requests for an algorithm with an interleaved kernel
+ * are collected for up to the batch window (or until its lanes are full) and
+ * hashed with one hash_multi call; every request still gets its own callback.
+ * A window of 0 coalesces the requests made during the same loop iteration,
+ * and setBatchWindow(false) queues every request on its own again.
+ */
+
+static int batch_window = 0;
+static uv_timer_t batch_timer;
+static bool batch_timer_ready;
+
+struct LaneRequest {
+    LaneRequest(Nan::Callback *callback, Local<Object> target, const algorithm_t *algo, const algorithm_params &params)
+        : callback(callback),
+          input(Buffer::Data(target), Buffer::Data(target) + Buffer::Length(target)),
+          ticket(algo, params, 1) {
+    }
+
+    ~LaneRequest() {
+        delete callback;
+    }
+
+    Nan::Callback *callback;
+    std::vector<char> input;
+    char output[32];
+    QueueTicket ticket;
+};
+
+class LaneWorker : public PoolWorker {
+public:
+    LaneWorker(const algorithm_t *algo, const algorithm_params &params, const WorkOptions &options)
+        : PoolWorker(NULL, options), algo(algo), params(params) {
+    }
+
+    ~LaneWorker() {
+        for (size_t i = 0; i < requests.size(); i++)
+            delete requests[i];
+    }
+
+    bool Accepts(const algorithm_params &other, const WorkOptions &other_options) const {
+        return requests.size() < algo->lanes && params.n == other.n && params.r == other.r &&
+            options.has_epoch == other_options.has_epoch && options.epoch == other_options.epoch &&
+            options.priority == other_options.priority;
+    }
+
+    bool Full() const {
+        return requests.size() >= algo->lanes;
+    }
+
+    void Add(LaneRequest *request) {
+        requests.push_back(request);
+        memory += algorithm_memory(algo, &params);
+    }
+
+    void Execute() {
+        std::vector<const char*> inputs(requests.size());
+        std::vector<char*> outputs(requests.size());
+        std::vector<uint32_t> lens(requests.size());
+
+        for (size_t i = 0; i < requests.size(); i++) {
+            inputs[i] = requests[i]->input.empty() ? NULL : &requests[i]->input[0];
+            outputs[i] = requests[i]->output;
+            lens[i] = requests[i]->input.size();
+        }
+
+        const char *err = RunAlgorithmMulti(algo, &inputs[0], &outputs[0], &lens[0], requests.size(), params);
+
+        if (err != NULL)
+            Fail(err);
+    }
+
+    void WorkComplete() {
+        for (size_t i = 0; i < requests.size(); i++)
+            requests[i]->ticket.Release();
+        PoolWorker::WorkComplete();
+    }
+
+    void HandleOKCallback() {
+        for (size_t i = 0; i < requests.size(); i++) {
+            Nan::HandleScope scope;
+
+            Local<Value> argv[] = {
+                Nan::Null(),
+                Nan::CopyBuffer(requests[i]->output, 32).ToLocalChecked()
+            };
+
+            requests[i]->callback->Call(2, argv);
+        }
+    }
+
+    void HandleErrorCallback() {
+        for (size_t i = 0; i < requests.size(); i++) {
+            Nan::HandleScope scope;
+
+            Local<Value> argv[] = {
+                Nan::Error(ErrorMessage())
+            };
+
+            requests[i]->callback->Call(1, argv);
+        }
+    }
+
+private:
+    const algorithm_t *algo;
+    algorithm_params params;
+    std::vector<LaneRequest*> requests;
+};
+
+static LaneWorker *collecting[ALGO_COUNT];
+
+static void FlushLanes(const algorithm_t *algo) {
+    LaneWorker *worker = collecting[algo - algorithms];
+
+    if (worker == NULL)
+        return;
+
+    collecting[algo - algorithms] = NULL;
+    GetPool(algo)->Queue(worker);
+}
+
+static void OnBatchWindow(uv_timer_t *timer) {
+    for (uint32_t i = 0; i < ALGO_COUNT; i++)
+        FlushLanes(&algorithms[i]);
+}
+
+static void CollectLane(const algorithm_t *algo, const algorithm_params &params, const WorkOptions &options, LaneRequest *request) {
+    LaneWorker *&worker = collecting[algo - algorithms];
+
+    if (worker != NULL && !worker->Accepts(params, options))
+        FlushLanes(algo);
+
+    if (worker == NULL) {
+        worker = new LaneWorker(algo, params, options);
+
+        if (!batch_timer_ready) {
+            uv_timer_init(uv_default_loop(), &batch_timer);
+            batch_timer_ready = true;
+        }
+        if (!uv_is_active((uv_handle_t*) &batch_timer))
+            uv_timer_start(&batch_timer, OnBatchWindow, batch_window, 0);
+    }
+
+    worker->Add(request);
+
+    if (worker->Full())
+        FlushLanes(algo);
+}
+
+NAN_METHOD(setBatchWindow) {
+    if (info.Length() < 1)
+        return THROW_ERROR_EXCEPTION("You must provide one argument.");
+
+    if (info[0]->IsBoolean() && !Nan::To<bool>(info[0]).FromJust()) {
+        batch_window = -1;
+        OnBatchWindow(NULL);
+        return;
+    }
+
+    if (!info[0]->IsUint32())
+        return THROW_ERROR_EXCEPTION("Argument 1 should be a number of milliseconds or false.");
+
+    batch_window = Nan::To<uint32_t>(info[0]).FromJust();
+}
+
+/* Queues info[first] (followed by any params) to be hashed with `algo`. */
+static void QueueHash(Nan::NAN_METHOD_ARGS_TYPE info, int first, const algorithm_t *algo) {
+    if (info.Length() < first + 2)
+        return THROW_ERROR_EXCEPTION("You must provide buffer to hash and a callback.");
+
+    Local<Object> target = Nan::To<Object>(info[first]).ToLocalChecked();
+
+    if(!Buffer::HasInstance(target))
+        return THROW_ERROR_EXCEPTION("Argument should be a buffer object.");
+
+    algorithm_params params;
+    WorkOptions options;
+    const char *err = GetParams(info, first + 1, algo, params);
+
+    if(err == NULL)
+        err = CheckInput(algo, Buffer::Length(target));
+
+    if(err == NULL)
+        err = GetOptions(info, options);
+
+    if(err != NULL)
+        return THROW_ERROR_EXCEPTION(err);
+
+    Nan::Callback *callback = GetCallback(info);
+
+    if(callback == NULL)
+        return THROW_ERROR_EXCEPTION("Last argument should be a callback function.");
+
+    if (WouldBlock(algo, params, 1))
+        return Reject(info, algo, callback);
+
+    info.GetReturnValue().Set(Nan::True());
+
+    if (algo->hash_multi != NULL && batch_window >= 0) {
+        CollectLane(algo, params, options, new LaneRequest(callback, target, algo, params));
+        return;
+    }
+
+    PoolWorker *worker = new AlgorithmWorker(callback, target, algo, params);
+
+    worker->options = options;
+    GetPool(algo)->Queue(worker);
+}
+
+NAN_METHOD(hashAsync) {
+    if (info.Length() < 1)
+        return THROW_ERROR_EXCEPTION("You must provide an algorithm, a buffer to hash and a callback.");
+
+    const algorithm_t *algo = GetAlgorithm(info[0]);
+
+    if(algo == NULL)
+        return THROW_ERROR_EXCEPTION("Unknown algorithm.");
+
+    QueueHash(info, 1, algo);
+}
+
+NAN_METHOD(quarkAsync) { QueueHash(info, 0, &algorithms[ALGO_QUARK]); }
+NAN_METHOD(x11Async) { QueueHash(info, 0, &algorithms[ALGO_X11]); }
+NAN_METHOD(scryptAsync) { QueueHash(info, 0, &algorithms[ALGO_SCRYPT]); }
+NAN_METHOD(scryptnAsync) { QueueHash(info, 0, &algorithms[ALGO_SCRYPTN]); }
+NAN_METHOD(keccakAsync) { QueueHash(info, 0, &algorithms[ALGO_KECCAK]); }
+NAN_METHOD(bcryptAsync) { QueueHash(info, 0, &algorithms[ALGO_BCRYPT]); }
+NAN_METHOD(skeinAsync) { QueueHash(info, 0, &algorithms[ALGO_SKEIN]); }
+NAN_METHOD(groestlAsync) { QueueHash(info, 0, &algorithms[ALGO_GROESTL]); }
+NAN_METHOD(groestlmyriadAsync) { QueueHash(info, 0, &algorithms[ALGO_GROESTLMYRIAD]); }
+NAN_METHOD(blakeAsync) { QueueHash(info, 0, &algorithms[ALGO_BLAKE]); }
+NAN_METHOD(blake2sAsync) { QueueHash(info, 0, &algorithms[ALGO_BLAKE2S]); }
+NAN_METHOD(fugueAsync) { QueueHash(info, 0, &algorithms[ALGO_FUGUE]); }
+NAN_METHOD(qubitAsync) { QueueHash(info, 0, &algorithms[ALGO_QUBIT]); }
+NAN_METHOD(hefty1Async) { QueueHash(info, 0, &algorithms[ALGO_HEFTY1]); }
+NAN_METHOD(shavite3Async) { QueueHash(info, 0, &algorithms[ALGO_SHAVITE3]); }
+NAN_METHOD(x13Async) { QueueHash(info, 0, &algorithms[ALGO_X13]); }
+NAN_METHOD(nist5Async) { QueueHash(info, 0, &algorithms[ALGO_NIST5]); }
+NAN_METHOD(sha1Async) { QueueHash(info, 0, &algorithms[ALGO_SHA1]); }
+NAN_METHOD(x15Async) { QueueHash(info, 0, &algorithms[ALGO_X15]); }
+NAN_METHOD(x17Async) { QueueHash(info, 0, &algorithms[ALGO_X17]); }
+NAN_METHOD(freshAsync) { QueueHash(info, 0, &algorithms[ALGO_FRESH]); }
+NAN_METHOD(whirlpoolxAsync) { QueueHash(info, 0, &algorithms[ALGO_WHIRLPOOLX]); }
+NAN_METHOD(zr5Async) { QueueHash(info, 0, &algorithms[ALGO_ZR5]); }
+NAN_METHOD(neoscryptAsync) { QueueHash(info, 0, &algorithms[ALGO_NEOSCRYPT]); }
+NAN_METHOD(yescryptAsync) { QueueHash(info, 0, &algorithms[ALGO_YESCRYPT]); }
+NAN_METHOD(lyra2reAsync) { QueueHash(info, 0, &algorithms[ALGO_LYRA2RE]); }
+NAN_METHOD(lyra2re2Async) { QueueHash(info, 0, &algorithms[ALGO_LYRA2RE2]); }
+NAN_METHOD(s3Async) { QueueHash(info, 0, &algorithms[ALGO_S3]); }
+NAN_METHOD(jhAsync) { QueueHash(info, 0, &algorithms[ALGO_JH]); }
+NAN_METHOD(x14Async) { QueueHash(info, 0, &algorithms[ALGO_X14]); }
+NAN_METHOD(c11Async) { QueueHash(info, 0, &algorithms[ALGO_C11]); }
+NAN_METHOD(dcryptAsync) { QueueHash(info, 0, &algorithms[ALGO_DCRYPT]); }
+NAN_METHOD(x5Async) { QueueHash(info, 0, &algorithms[ALGO_X5]); }
+
+NAN_METHOD(cryptonightAsync) {
+    bool fast = false;
+
+    if (info.Length() >= 3 && !IsOptions(info[1])) {
+        if(!info[1]->IsBoolean())
+            return THROW_ERROR_EXCEPTION("Argument 2 should be a boolean");
+        fast = Nan::To<bool>(info[1]).FromJust();
+    }
+
+    QueueHash(info, 0, &algorithms[fast ? ALGO_CRYPTONIGHT_FAST : ALGO_CRYPTONIGHT]);
+}
+
+NAN_METHOD(boolberryAsync) {
+    if (info.Length() < 3)
+        return THROW_ERROR_EXCEPTION("You must provide two buffers and a callback.");
+
+    Local<Object> target = Nan::To<Object>(info[0]).ToLocalChecked();
+    Local<Object> target_spad = Nan::To<Object>(info[1]).ToLocalChecked();
+    uint32_t height = 1;
+
+    if(!Buffer::HasInstance(target))
+        return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
+
+    if(!Buffer::HasInstance(target_spad))
+        return THROW_ERROR_EXCEPTION("Argument 2 should be a buffer object.");
+
+    WorkOptions options;
+    const char *err = GetOptions(info, options);
+
+    if(err != NULL)
+        return THROW_ERROR_EXCEPTION(err);
+
+    // the height, if given, comes before the options object
+    if(info.Length() >= (IsOptions(info[info.Length() - 2]) ? 5 : 4)) {
+        if(info[2]->IsUint32()) {
+            height = Nan::To<uint32_t>(info[2]).FromJust();
+        } else {
+            return THROW_ERROR_EXCEPTION("Argument 3 should be an unsigned integer.");
+        }
+    }
+
+    Nan::Callback *callback = GetCallback(info);
+
+    if(callback == NULL)
+        return THROW_ERROR_EXCEPTION("Last argument should be a callback function.");
+
+    // hundreds of megabytes of scratchpad reads, scheduled with the memory-hard hashes
+    WorkPool *pool = GetPool(GROUP_HARD);
+
+    if (WouldBlock(1))
+        return Reject(info, pool, callback);
+
+    info.GetReturnValue().Set(Nan::True());
+
+    PoolWorker *worker = new BoolberryWorker(callback, target, target_spad, height);
+
+    worker->options = options;
+    pool->Queue(worker);
+}
+
+/*
+ * Batch hashing. hashBatch(algo, buffers, ...params) or
+ * hashBatch(algo, packed, stride, ...params) hashes every input of one
+ * algorithm in a single native call and returns all digests back to back
+ * in one Buffer of count * 32 bytes.
+ */
+
+struct BatchInputs {
+    std::vector<const char*> data;
+    std::vector<uint32_t> lengths;
+};
+
+/*
+ * Returns an error message, or NULL once `inputs` points at every input of
+ * the batch and `params_index` at the argument following the inputs.
+ */
+static const char *GetBatchInputs(Nan::NAN_METHOD_ARGS_TYPE info, const algorithm_t *algo, BatchInputs &inputs, int &params_index) {
+    if (info[1]->IsArray()) {
+        Local<Array> buffers = info[1].As<Array>();
+
+        for (uint32_t i = 0; i < buffers->Length(); i++) {
+            Local<Value> item = Nan::Get(buffers, i).ToLocalChecked();
+
+            if(!Buffer::HasInstance(item))
+                return "Every batch item should be a buffer object.";
+
+            if(CheckInput(algo, Buffer::Length(item)) != NULL)
+                return CheckInput(algo, Buffer::Length(item));
+
+            inputs.data.push_back(Buffer::Data(item));
+            inputs.lengths.push_back(Buffer::Length(item));
+        }
+
+        params_index = 2;
+        return NULL;
+    }
+
+    if(!Buffer::HasInstance(info[1]))
+        return "Argument 2 should be an array of buffers or a buffer.";
+
+    if(info.Length() < 3 || !info[2]->IsUint32())
+        return "A packed buffer needs a stride.";
+
+    uint32_t stride = Nan::To<uint32_t>(info[2]).FromJust();
+    char *packed = Buffer::Data(info[1]);
+    size_t packed_len = Buffer::Length(info[1]);
+
+    if(stride == 0 || packed_len % stride != 0)
+        return "Buffer length should be a multiple of the stride.";
+
+    if(CheckInput(algo, stride) != NULL)
+        return CheckInput(algo, stride);
+
+    for (size_t offset = 0; offset < packed_len; offset += stride) {
+        inputs.data.push_back(packed + offset);
+        inputs.lengths.push_back(stride);
+    }
+
+    params_index = 3;
+    return NULL;
+}
+
+/* Returns an error message or NULL, stopping at the first failed hash. */
+static const char *HashBatchRange(const algorithm_t *algo, const algorithm_params &params, const BatchInputs &inputs, char *output, size_t begin, size_t end) {
+    const char *err;
+
+    if (algo->hash_multi == NULL) {
+        for (size_t i = begin; i < end; i++) {
+            if ((err = RunAlgorithm(algo, inputs.data[i], output + i * 32, inputs.lengths[i], params)) != NULL)
+                return err;
+        }
+        return NULL;
+    }
+
+    /* feed the interleaved kernel a full set of lanes at a time */
+    std::vector<char*> outputs(algo->lanes);
+
+    for (size_t i = begin; i < end; i += algo->lanes) {
+        uint32_t count = end - i < algo->lanes ? end - i : algo->lanes;
+
+        for (uint32_t lane = 0; lane < count; lane++)
+            outputs[lane] = output + (i + lane) * 32;
+        if ((err = RunAlgorithmMulti(algo, &inputs.data[i], &outputs[0], &inputs.lengths[i], count, params)) != NULL)
+            return err;
+    }
+    return NULL;
+}
+
+NAN_METHOD(hashBatch) {
+    if (info.Length() < 2)
+        return THROW_ERROR_EXCEPTION("You must provide an algorithm and the inputs to hash.");
+
+    const algorithm_t *algo = GetAlgorithm(info[0]);
+
+    if(algo == NULL)
+        return THROW_ERROR_EXCEPTION("Unknown algorithm.");
+
+    BatchInputs inputs;
+    algorithm_params params;
+    int params_index;
+    const char *err = GetBatchInputs(info, algo, inputs, params_index);
+
+    if(err == NULL)
+        err = GetParams(info, params_index, algo, params);
+
+    if(err != NULL)
+        return THROW_ERROR_EXCEPTION(err);
+
+    size_t count = inputs.data.size();
+    char *output = (char*) malloc(sizeof(char) * 32 * (count ? count : 1));
+
+    if((err = HashBatchRange(algo, params, inputs, output, 0, count)) != NULL) {
+        free(output);
+        return THROW_ERROR_EXCEPTION(err);
+    }
+
+    info.GetReturnValue().Set(Nan::NewBuffer(output, 32 * count).ToLocalChecked());
+}
+
+/*
+ * hashBatchAsync splits the batch into a few slices per pool thread, so
+ * threads that finish early steal the remaining slices of slower ones.
+ * Slices complete on the main thread, so the last one to finish owns the
+ * callback and the result buffer without any locking. If any slice was
+ * cancelled the whole batch calls back with its error.
+ */
+struct BatchJob {
+    BatchJob(const algorithm_t *algo, const algorithm_params &params, Nan::Callback *callback, size_t pending, size_t count)
+        : algo(algo), params(params), callback(callback), pending(pending), ticket(algo, params, count) {
+    }
+
+    ~BatchJob() {
+        delete callback;
+    }
+
+    const algorithm_t *algo;
+    algorithm_params params;
+    Nan::Callback *callback;
+    size_t pending;
+    std::vector<char> storage;
+    BatchInputs inputs;
+    std::vector<char> output;
+    std::string error;
+    QueueTicket ticket;
+};
+
+class BatchWorker : public PoolWorker {
+public:
+    BatchWorker(BatchJob *job, size_t begin, size_t end, const WorkOptions &options)
+        : PoolWorker(NULL, options), job(job), begin(begin), end(end) {
+        // HashBatchRange keeps one set of lanes in flight at a time
+        size_t lanes = job->algo->hash_multi != NULL ? job->algo->lanes : 1;
+
+        memory = algorithm_memory(job->algo, &job->params) * (end - begin < lanes ? end - begin : lanes);
+    }
+
+    void Execute() {
+        const char *err = HashBatchRange(job->algo, job->params, job->inputs, job->output.empty() ? NULL : &job->output[0], begin, end);
+
+        if (err != NULL)
+            Fail(err);
+    }
+
+    void HandleOKCallback() {
+        if (--job->pending > 0)
+            return;
+
+        Nan::HandleScope scope;
+
+        job->ticket.Release();
+
+        if (!job->error.empty()) {
+            Local<Value> argv[] = {
+                Nan::Error(job->error.c_str())
+            };
+
+            job->callback->Call(1, argv);
+        } else {
+            Local<Value> argv[] = {
+                Nan::Null(),
+                Nan::CopyBuffer(job->output.empty() ? NULL : &job->output[0], job->output.size()).ToLocalChecked()
+            };
+
+            job->callback->Call(2, argv);
+        }
+        delete job;
+    }
+
+    void HandleErrorCallback() {
+        job->error = ErrorMessage();
+        HandleOKCallback();
+    }
+
+private:
+    BatchJob *job;
+    size_t begin;
+    size_t end;
+};
+
+#define BATCH_SLICES_PER_THREAD 4
+
+NAN_METHOD(hashBatchAsync) {
+    if (info.Length() < 3)
+        return THROW_ERROR_EXCEPTION("You must provide an algorithm, the inputs to hash and a callback.");
+
+    const algorithm_t *algo = GetAlgorithm(info[0]);
+
+    if(algo == NULL)
+        return THROW_ERROR_EXCEPTION("Unknown algorithm.");
+
+    BatchInputs inputs;
+    algorithm_params params;
+    WorkOptions options;
+    int params_index;
+    const char *err = GetBatchInputs(info, algo, inputs, params_index);
+
+    if(err == NULL)
+        err = GetParams(info, params_index, algo, params);
+
+    if(err == NULL)
+        err = GetOptions(info, options);
+
+    if(err != NULL)
+        return THROW_ERROR_EXCEPTION(err);
+
+    Nan::Callback *callback = GetCallback(info);
+
+    if(callback == NULL)
+        return THROW_ERROR_EXCEPTION("Last argument should be a callback function.");
+
+    size_t count = inputs.data.size();
+
+    if (WouldBlock(algo, params, count))
+        return Reject(info, algo, callback);
+
+    info.GetReturnValue().Set(Nan::True());
+
+    size_t threads = (algo->flags & ALGORITHM_THREAD_SAFE) ? GetPool(algo)->Size() * BATCH_SLICES_PER_THREAD : 1;
+    // slices are cut between whole sets of lanes so interleaved kernels stay full
+    size_t lanes = algo->hash_multi != NULL ? algo->lanes : 1;
+    size_t groups = (count + lanes - 1) / lanes;
+    size_t slices = groups < threads ? groups : threads;
+    BatchJob *job = new BatchJob(algo, params, callback, slices ? slices : 1, count);
+
+    // copy the inputs so the caller may reuse its buffers right away
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+        total += inputs.lengths[i];
+
+    job->storage.resize(total);
+    job->inputs.lengths = inputs.lengths;
+    job->output.resize(32 * count);
+
+    for (size_t i = 0, offset = 0; i < count; offset += inputs.lengths[i], i++) {
+        if (inputs.lengths[i] > 0)
+            memcpy(&job->storage[offset], inputs.data[i], inputs.lengths[i]);
+        job->inputs.data.push_back(job->storage.empty() ? NULL : &job->storage[offset]);
+    }
+
+    if (slices == 0) {
+        GetPool(algo)->Queue(new BatchWorker(job, 0, 0, options));
+        return;
+    }
+
+    for (size_t i = 0; i < slices; i++) {
+        size_t begin = groups * i / slices * lanes;
+        size_t end = groups * (i + 1) / slices * lanes;
+
+        GetPool(algo)->Queue(new BatchWorker(job, begin, end < count ? end : count, options));
+    }
+}
+
+/*
+ * cancelEpoch(tag) drops every queued async and batch job submitted with
+ * { epoch: tag }; their callbacks get a "Job was cancelled." error. Hashes
+ * already running on a worker thread, and work without an epoch, still
+ * complete normally.
+ */
+NAN_METHOD(cancelEpoch) {
+    if (info.Length() < 1 || !info[0]->IsUint32())
+        return THROW_ERROR_EXCEPTION("Argument 1 should be an unsigned integer.");
+
+    uint32_t epoch = Nan::To<uint32_t>(info[0]).FromJust();
+
+    // requests still waiting for lanes are queued first so they are dropped too
+    for (uint32_t i = 0; i < ALGO_COUNT; i++) {
+        if (collecting[i] != NULL && collecting[i]->options.InEpoch(epoch))
+            FlushLanes(&algorithms[i]);
+    }
+
+    for (int i = 0; i < GROUP_COUNT; i++) {
+        if (pools[i] != NULL)
+            pools[i]->Cancel(epoch);
+    }
+}
+
+/*
+ * hashInto(algo, input, output, offset, ...params) writes the 32 byte
+ * digest straight into output[offset..offset + 32), where output is a
+ * Buffer or any other TypedArray the caller allocated once. Returns the
+ * offset just past the digest so consecutive calls can fill a results
+ * array without allocating.
+ */
+NAN_METHOD(hashInto) {
+    if (info.Length() < 3)
+        return THROW_ERROR_EXCEPTION("You must provide an algorithm, a buffer to hash and an output buffer.");
+
+    const algorithm_t *algo = GetAlgorithm(info[0]);
+
+    if(algo == NULL)
+        return THROW_ERROR_EXCEPTION("Unknown algorithm.");
+
+    if(!Buffer::HasInstance(info[1]))
+        return THROW_ERROR_EXCEPTION("Argument 2 should be a buffer object.");
+
+    if(!info[2]->IsArrayBufferView())
+        return THROW_ERROR_EXCEPTION("Argument 3 should be a buffer or typed array.");
+
+    uint32_t offset = 0;
+
+    if(info.Length() >= 4 && !info[3]->IsUndefined()) {
+        if(!info[3]->IsUint32())
+            return THROW_ERROR_EXCEPTION("Argument 4 should be an unsigned integer.");
+        offset = Nan::To<uint32_t>(info[3]).FromJust();
+    }
+
+    algorithm_params params;
+    const char *err = GetParams(info, 4, algo, params);
+
+    if(err == NULL)
+        err = CheckInput(algo, Buffer::Length(info[1]));
+
+    if(err != NULL)
+        return THROW_ERROR_EXCEPTION(err);
+
+    Nan::TypedArrayContents<char> output(info[2]);
+
+    if(*output == NULL || output.length() < 32 || offset > output.length() - 32)
+        return THROW_ERROR_EXCEPTION("Output buffer is too small for a digest at this offset.");
+
+    if((err = RunAlgorithm(algo, Buffer::Data(info[1]), *output + offset, Buffer::Length(info[1]), params)) != NULL)
+        return THROW_ERROR_EXCEPTION(err);
+
+    info.GetReturnValue().Set(offset + 32);
+}
+
+/*
+ * checkShare(algo, header, shareTarget, networkTarget, ...params) hashes the
+ * header and compares the digest against both 32 byte little-endian targets
+ * without going through bignums in JS. Difficulty is relative to the
+ * 0x00000000ffff0000... diff1 target, before any per-algorithm multiplier.
+ */
+
+static uint64_t ReadWord(const uint8_t *bytes, int word) {
+    uint64_t value = 0;
+
+    for (int i = 7; i >= 0; i--)
+        value = (value << 8) | bytes[word * 8 + i];
+    return value;
+}
+
+// hash <= target, deciding on the most significant word that differs
+static bool MeetsTarget(const uint8_t *hash, const uint8_t *target) {
+    for (int word = 3; word >= 0; word--) {
+        uint64_t h = ReadWord(hash, word), t = ReadWord(target, word);
+
+        if (h != t)
+            return h < t;
+    }
+    return true;
+}
+
+static double HashDifficulty(const uint8_t *hash) {
+    double value = 0;
+
+    for (int word = 3; word >= 0; word--)
+        value = value * 18446744073709551616.0 + (double) ReadWord(hash, word);
+    // diff1 is 0xffff << 208
+    return ldexp(65535.0, 208) / value;
+}
+
+NAN_METHOD(checkShare) {
+    if (info.Length() < 4)
+        return THROW_ERROR_EXCEPTION("You must provide an algorithm, a header and the share and network targets.");
+
+    const algorithm_t *algo = GetAlgorithm(info[0]);
+
+    if(algo == NULL)
+        return THROW_ERROR_EXCEPTION("Unknown algorithm.");
+
+    if(!Buffer::HasInstance(info[1]))
+        return THROW_ERROR_EXCEPTION("Argument 2 should be a buffer object.");
+
+    if(!Buffer::HasInstance(info[2]) || Buffer::Length(info[2]) != 32 ||
+       !Buffer::HasInstance(info[3]) || Buffer::Length(info[3]) != 32)
+        return THROW_ERROR_EXCEPTION("Targets should be 32 byte buffers.");
+
+    algorithm_params params;
+    const char *err = GetParams(info, 4, algo, params);
+
+    if(err == NULL)
+        err = CheckInput(algo, Buffer::Length(info[1]));
+
+    if(err != NULL)
+        return THROW_ERROR_EXCEPTION(err);
+
+    uint8_t digest[32];
+
+    if((err = RunAlgorithm(algo, Buffer::Data(info[1]), (char*) digest, Buffer::Length(info[1]), params)) != NULL)
+        return THROW_ERROR_EXCEPTION(err);
+
+    const uint8_t *shareTarget = (const uint8_t*) Buffer::Data(info[2]);
+    const uint8_t *networkTarget = (const uint8_t*) Buffer::Data(info[3]);
+    Local<Object> result = Nan::New<Object>();
+
+    Nan::Set(result, Nan::New("meetsShare").ToLocalChecked(), Nan::New<Boolean>(MeetsTarget(digest, shareTarget)));
+    Nan::Set(result, Nan::New("meetsBlock").ToLocalChecked(), Nan::New<Boolean>(MeetsTarget(digest, networkTarget)));
+    Nan::Set(result, Nan::New("difficulty").ToLocalChecked(), Nan::New<Number>(HashDifficulty(digest)));
+    Nan::Set(result, Nan::New("hash").ToLocalChecked(), Nan::CopyBuffer((char*) digest, 32).ToLocalChecked());
+
+    info.GetReturnValue().Set(result);
+}
+
+/*
+ * prepareHeader(algo, header, ...params) captures the hash state after the
+ * constant first 76 bytes of an 80 byte header in an opaque object, and
+ * hashNonce(prepared, nonce) finishes the hash from a copy of it for one
+ * nonce, given as a number (written little-endian) or a 4 byte buffer.
+ * Algorithms without a midstate hash the whole header again. The state and
+ * the checked params stay on the native side, JS only holds the handle.
+ */
+class PreparedHeader : public Nan::ObjectWrap {
+public:
+    static void Init() {
+        Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(New);
+
+        tpl->SetClassName(Nan::New("PreparedHeader").ToLocalChecked());
+        tpl->InstanceTemplate()->SetInternalFieldCount(1);
+        type.Reset(tpl);
+        constructor.Reset(Nan::GetFunction(tpl).ToLocalChecked());
+    }
+
+    static Local<Object> Create(const algorithm_t *algo, const algorithm_params &params, const char *header) {
+        Local<Object> object = Nan::NewInstance(Nan::New(constructor)).ToLocalChecked();
+        PreparedHeader *prepared = ObjectWrap::Unwrap<PreparedHeader>(object);
+
+        memset(prepared->header, 0, sizeof(prepared->header));
+        memset(prepared->state, 0, sizeof(prepared->state));
+        memcpy(prepared->header, header, 76);
+        prepared->params = params;
+        prepared->algo = algo;
+
+        if (algo->prepare != NULL)
+            algo->prepare(prepared->state, prepared->header);
+
+        return object;
+    }
+
+    // NULL unless value came from Create()
+    static PreparedHeader *From(Local<Value> value) {
+        if (!Nan::New(type)->HasInstance(value))
+            return NULL;
+
+        return ObjectWrap::Unwrap<PreparedHeader>(value.As<Object>());
+    }
+
+    const algorithm_t *algo;
+    algorithm_params params;
+    char header[80];
+    uint64_t state[ALGORITHM_PREPARED_SIZE / sizeof(uint64_t)];
+
+private:
+    PreparedHeader() : algo(NULL) {
+    }
+
+    static NAN_METHOD(New) {
+        if (!info.IsConstructCall())
+            return THROW_ERROR_EXCEPTION("PreparedHeader is created by prepareHeader.");
+
+        (new PreparedHeader())->Wrap(info.This());
+        info.GetReturnValue().Set(info.This());
+    }
+
+    static Nan::Persistent<FunctionTemplate> type;
+    static Nan::Persistent<Function> constructor;
+};
+
+Nan::Persistent<FunctionTemplate> PreparedHeader::type;
+Nan::Persistent<Function> PreparedHeader::constructor;
+
+NAN_METHOD(prepareHeader) {
+    if (info.Length() < 2)
+        return THROW_ERROR_EXCEPTION("You must provide an algorithm and a header.");
+
+    const algorithm_t *algo = GetAlgorithm(info[0]);
+
+    if(algo == NULL)
+        return THROW_ERROR_EXCEPTION("Unknown algorithm.");
+
+    if(!Buffer::HasInstance(info[1]))
+        return THROW_ERROR_EXCEPTION("Argument 2 should be a buffer object.");
+
+    if(Buffer::Length(info[1]) < 76)
+        return THROW_ERROR_EXCEPTION("Header should be at least 76 bytes.");
+
+    algorithm_params params;
+    const char *err = GetParams(info, 2, algo, params);
+
+    if(err != NULL)
+        return THROW_ERROR_EXCEPTION(err);
+
+    info.GetReturnValue().Set(PreparedHeader::Create(algo, params, Buffer::Data(info[1])));
+}
+
+NAN_METHOD(hashNonce) {
+    if (info.Length() < 2)
+        return THROW_ERROR_EXCEPTION("You must provide a prepared header and a nonce.");
+
+    PreparedHeader *prepared = PreparedHeader::From(info[0]);
+
+    // a constructor reached through the prototype makes objects without an algorithm
+    if(prepared == NULL || prepared->algo == NULL)
+        return THROW_ERROR_EXCEPTION("Argument 1 should be an object from prepareHeader.");
+
+    char header[80];
+
+    memcpy(header, prepared->header, 76);
+
+    if (Buffer::HasInstance(info[1]) && Buffer::Length(info[1]) == 4) {
+        memcpy(header + 76, Buffer::Data(info[1]), 4);
+    } else if (info[1]->IsNumber()) {
+        uint32_t nonce = Nan::To<uint32_t>(info[1]).FromJust();
+
+        for (int i = 0; i < 4; i++)
+            header[76 + i] = (char) (nonce >> (8 * i));
+    } else {
+        return THROW_ERROR_EXCEPTION("Nonce should be a number or a 4 byte buffer.");
+    }
+
+    const algorithm_t *algo = prepared->algo;
+    char *output = (char*) malloc(sizeof(char) * algo->output_len);
+    const char *err = NULL;
+
+    if (algo->hash_nonce != NULL) {
+        algo->hash_nonce(prepared->state, header, output, &prepared->params);
+        if (scratchpad_failed())
+            err = SCRATCHPAD_ERROR;
+    } else {
+        err = RunAlgorithm(algo, header, output, 80, prepared->params);
+    }
+
+    if (err != NULL) {
+        free(output);
+        return THROW_ERROR_EXCEPTION(err);
+    }
+
+    info.GetReturnValue().Set(Nan::NewBuffer(output, algo->output_len).ToLocalChecked());
+}
+
 NAN_MODULE_INIT(init) {
+    uv_mutex_init(&serial_lock);
+    PreparedHeader::Init();
+
     Nan::Set(target, Nan::New("quark").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(quark)).ToLocalChecked());
     Nan::Set(target, Nan::New("x11").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(x11)).ToLocalChecked());
     Nan::Set(target, Nan::New("scrypt").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(scrypt)).ToLocalChecked());
@@ -802,7 +2319,7 @@ NAN_MODULE_INIT(init) {
     Nan::Set(target, Nan::New("sha1").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(sha1)).ToLocalChecked());
     Nan::Set(target, Nan::New("x15").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(x15)).ToLocalChecked());
     Nan::Set(target, Nan::New("x17").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(x17)).ToLocalChecked());
-	Nan::Set(target, Nan::New("fresh").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(fresh)).ToLocalChecked());
+    Nan::Set(target, Nan::New("fresh").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(fresh)).ToLocalChecked());
     Nan::Set(target, Nan::New("whirlpoolx").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(whirlpoolx)).ToLocalChecked());
     Nan::Set(target, Nan::New("zr5").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(zr5)).ToLocalChecked());
     Nan::Set(target, Nan::New("neoscrypt").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(neoscrypt)).ToLocalChecked());
@@ -811,6 +2328,67 @@ NAN_MODULE_INIT(init) {
     Nan::Set(target, Nan::New("lyra2re2").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(lyra2re2)).ToLocalChecked());
     Nan::Set(target, Nan::New("s3").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(s3)).ToLocalChecked());
     Nan::Set(target, Nan::New("jh").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(jh)).ToLocalChecked());
+    Nan::Set(target, Nan::New("x14").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(x14)).ToLocalChecked());
+    Nan::Set(target, Nan::New("c11").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(c11)).ToLocalChecked());
+    Nan::Set(target, Nan::New("dcrypt").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(dcrypt)).ToLocalChecked());
+    Nan::Set(target, Nan::New("x5").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(x5)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("quarkAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(quarkAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("x11Async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(x11Async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("scryptAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(scryptAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("scryptnAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(scryptnAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("keccakAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(keccakAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("bcryptAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(bcryptAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("skeinAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(skeinAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("groestlAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(groestlAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("groestlmyriadAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(groestlmyriadAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("blakeAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(blakeAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("blake2sAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(blake2sAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("fugueAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(fugueAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("qubitAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(qubitAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("hefty1Async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(hefty1Async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("shavite3Async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(shavite3Async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("cryptonightAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(cryptonightAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("x13Async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(x13Async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("boolberryAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(boolberryAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("nist5Async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(nist5Async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("sha1Async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(sha1Async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("x15Async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(x15Async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("x17Async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(x17Async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("freshAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(freshAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("whirlpoolxAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(whirlpoolxAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("zr5Async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(zr5Async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("neoscryptAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(neoscryptAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("yescryptAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(yescryptAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("lyra2reAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(lyra2reAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("lyra2re2Async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(lyra2re2Async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("s3Async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(s3Async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("jhAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(jhAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("x14Async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(x14Async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("c11Async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(c11Async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("dcryptAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(dcryptAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("x5Async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(x5Async)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("hash").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(hash)).ToLocalChecked());
+    Nan::Set(target, Nan::New("hashAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(hashAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("listAlgorithms").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(listAlgorithms)).ToLocalChecked());
+    Nan::Set(target, Nan::New("hashBatch").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(hashBatch)).ToLocalChecked());
+    Nan::Set(target, Nan::New("hashBatchAsync").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(hashBatchAsync)).ToLocalChecked());
+    Nan::Set(target, Nan::New("hashInto").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(hashInto)).ToLocalChecked());
+    Nan::Set(target, Nan::New("checkShare").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(checkShare)).ToLocalChecked());
+    Nan::Set(target, Nan::New("prepareHeader").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(prepareHeader)).ToLocalChecked());
+    Nan::Set(target, Nan::New("hashNonce").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(hashNonce)).ToLocalChecked());
+    Nan::Set(target, Nan::New("trimScratchpads").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(trimScratchpads)).ToLocalChecked());
+    Nan::Set(target, Nan::New("scratchpadStats").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(scratchpadStats)).ToLocalChecked());
+    Nan::Set(target, Nan::New("setHugePages").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(setHugePages)).ToLocalChecked());
+    Nan::Set(target, Nan::New("setWorkerThreads").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(setWorkerThreads)).ToLocalChecked());
+    Nan::Set(target, Nan::New("workerThreads").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(workerThreads)).ToLocalChecked());
+    Nan::Set(target, Nan::New("setMemoryBudget").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(setMemoryBudget)).ToLocalChecked());
+    Nan::Set(target, Nan::New("setBatchWindow").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(setBatchWindow)).ToLocalChecked());
+    Nan::Set(target, Nan::New("cancelEpoch").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(cancelEpoch)).ToLocalChecked());
+    Nan::Set(target, Nan::New("setQueueLimits").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(setQueueLimits)).ToLocalChecked());
+    Nan::Set(target, Nan::New("wouldBlock").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(wouldBlock)).ToLocalChecked());
+    Nan::Set(target, Nan::New("queueStats").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(queueStats)).ToLocalChecked());
 }
 
 NODE_MODULE(multihashing, init)
@@ -33,6 +33,7 @@
 #include <string.h>
 
 #include "neoscrypt.h"
+#include "scratchpad.h"
 
 
 #ifdef SHA256
@@ -2577,7 +2578,20 @@ static void neoscrypt_blkmix(uint *X, uint *Y, uint r, uint mixmode) {
  *     01001 = N of 1024;
  *     .....
  *     11110 = N of 2147483648;
- *   profile bits 30 to 13 are reserved */
+ *   profile bits 30 to 13 are reserved;
+ *   N * r is limited to 2^27, see neoscrypt_profile_supported() */
+int neoscrypt_profile_supported(uint profile) {
+    uint shift;
+
+    if(!(profile >> 31))
+        return(1);
+
+    /* log2(N * r) */
+    shift = ((profile >> 8) & 0x1F) + 1 + ((profile >> 5) & 0x7);
+
+    return((shift <= 27) && (((size_t)1 << shift) <= SIZE_MAX / 256));
+}
+
 void neoscrypt(const uchar *password, uchar *output, uint profile) {
     const size_t stack_align = 0x40;
     uint N = 128, r = 2, dblmix = 1, mixmode = 0x14;
@@ -2591,12 +2605,21 @@ void neoscrypt(const uchar *password, uchar *output, uint profile) {
         mixmode = 0x08;  /* 8 rounds */
     }
 
+    if(!neoscrypt_profile_supported(profile)) {
+        memset(output, 0, 32);
+        return;
+    }
+
     if(profile >> 31) {
         N = (1 << (((profile >> 8) & 0x1F) + 1));
         r = (1 << ((profile >> 5) & 0x7));
     }
 
-    uchar stack[(N + 3) * r * 2 * BLOCK_SIZE + stack_align];
+    uchar *stack = scratchpad_acquire(((size_t)N + 3) * r * 2 * BLOCK_SIZE + stack_align);
+    if(stack == NULL) {
+        memset(output, 0, 32);
+        return;
+    }
     /* X = r * 2 * BLOCK_SIZE */
     X = (uint *) (((size_t)stack & ~(stack_align - 1)) + stack_align);
     /* Z is a copy of X for ChaCha */
@@ -2710,6 +2733,7 @@ void neoscrypt(const uchar *password, uchar *output, uint profile) {
 
     }
 
+    scratchpad_release(stack);
 }
 
 #endif /* !(ASM) */
@@ -5,6 +5,10 @@ extern "C" {
 void neoscrypt(const unsigned char *password, unsigned char *output,
   unsigned int profile);
 
+/* Non-zero if neoscrypt() can run the profile: custom N * r is limited so
+ * that V stays within 32-bit word indices and its size within a size_t. */
+int neoscrypt_profile_supported(unsigned int profile);
+
 void neoscrypt_blake2s(const void *input, const unsigned int input_size,
   const void *key, const unsigned char key_size,
   void *output, const unsigned char output_size);
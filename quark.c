@@ -38,6 +38,7 @@
 #include "sha3/sph_jh.h"
 #include "sha3/sph_keccak.h"
 #include "sha3/sph_skein.h"
+#include "sha3/blake512_4way.h"
 
 
 static __inline uint32_t
@@ -106,7 +107,8 @@ be32dec_vect(uint32_t *dst, const unsigned char *src, uint32_t len)
 		dst[i] = be32dec(src + i * 4);
 }
 
-void quark_hash(const char* input, char* output, uint32_t len)
+/* stages 2 to 9, from the blake512 digest in hashA */
+static void quark_chain(uint32_t hashA[16], char* output)
 {
     sph_blake512_context     ctx_blake;
     sph_bmw512_context       ctx_bmw;
@@ -118,14 +120,7 @@ void quark_hash(const char* input, char* output, uint32_t len)
     uint32_t mask = 8;
     uint32_t zero = 0;
 
-    uint32_t hashA[16], hashB[16];
-
-
-
-    sph_blake512_init(&ctx_blake);
-    sph_blake512 (&ctx_blake, input, len);
-    sph_blake512_close (&ctx_blake, hashA);	 //0
-
+    uint32_t hashB[16];
 
     sph_bmw512_init(&ctx_bmw);
     sph_bmw512 (&ctx_bmw, hashA, 64);    //0
@@ -207,4 +202,21 @@ void quark_hash(const char* input, char* output, uint32_t len)
 
 }
 
+void quark_hash(const char* input, char* output, uint32_t len)
+{
+    sph_blake512_context     ctx_blake;
+    uint32_t hashA[16];
+
+    sph_blake512_init(&ctx_blake);
+    sph_blake512 (&ctx_blake, input, len);
+    sph_blake512_close (&ctx_blake, hashA);
+
+    quark_chain(hashA, output);
+}
+
+/* four equal length inputs share one 4-way blake512 pass */
+void quark_multi_hash(const char* const* input, char* const* output, const uint32_t* len, uint32_t count)
+{
+    blake512_4way_chain(input, output, len, count, quark_chain);
+}
 
@@ -8,6 +8,7 @@ extern "C" {
 #include <stdint.h>
 
 void quark_hash(const char* input, char* output, uint32_t len);
+void quark_multi_hash(const char* const* input, char* const* output, const uint32_t* len, uint32_t count);
 
 #ifdef __cplusplus
 }
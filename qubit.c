@@ -7,7 +7,7 @@
 #include "sha3/sph_luffa.h"
 #include "sha3/sph_shavite.h"
 #include "sha3/sph_simd.h"
-#include "sha3/sph_echo.h"
+#include "sha3/echo_aesni.h"
 
 void qubit_hash(const char* input, char* output, uint32_t len)
 {
@@ -15,7 +15,6 @@ void qubit_hash(const char* input, char* output, uint32_t len)
     sph_cubehash512_context ctx_cubehash;
     sph_shavite512_context  ctx_shavite;
     sph_simd512_context     ctx_simd;
-    sph_echo512_context     ctx_echo;
     
     char hash1[64];
     char hash2[64];
@@ -36,9 +35,7 @@ void qubit_hash(const char* input, char* output, uint32_t len)
     sph_simd512(&ctx_simd, (const void*) &hash1, 64); // 4
     sph_simd512_close(&ctx_simd, (void*) &hash2); // 5
     
-    sph_echo512_init(&ctx_echo);
-    sph_echo512(&ctx_echo, (const void*) &hash2, 64); // 5
-    sph_echo512_close(&ctx_echo, (void*) &hash1); // 6
+    echo512_64((const void*) &hash2, (void*) &hash1); // 5, 6
     
     memcpy(output, &hash1, 32);
 }
@@ -0,0 +1,348 @@
+#include "scratchpad.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#define SCRATCHPAD_ALIGN    64
+#define SCRATCHPAD_ROUND(n) (((n) + SCRATCHPAD_ALIGN - 1) & ~(size_t)(SCRATCHPAD_ALIGN - 1))
+
+#define HUGE_PAGE_SIZE      ((size_t)2 * 1024 * 1024)
+#define HUGE_PAGE_ROUND(n)  (((n) + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1))
+
+/* smaller arenas stay within TLB reach and would waste most of a huge page */
+#define HUGE_PAGE_THRESHOLD (HUGE_PAGE_SIZE / 2)
+
+/* what actually backs a mapping */
+#define SCRATCHPAD_PAGES_SMALL          0
+#define SCRATCHPAD_PAGES_TRANSPARENT    1   /* madvise(MADV_HUGEPAGE) accepted */
+#define SCRATCHPAD_PAGES_HUGE           2   /* MAP_HUGETLB */
+
+/* overflow allocations carry their region in front of the returned pointer */
+typedef struct {
+    size_t size;
+    size_t mapped;
+    int pages;
+} scratchpad_header;
+
+typedef struct scratchpad_arena {
+    struct scratchpad_arena* prev;
+    struct scratchpad_arena* next;
+    pthread_mutex_t lock;       /* owner vs. scratchpad_trim/scratchpad_stats */
+    uint8_t* base;
+    size_t size;
+    size_t mapped;              /* 0 when base came from the heap */
+    int pages;                  /* SCRATCHPAD_PAGES_* backing base */
+    size_t used;                /* bytes handed out from base */
+    size_t overflow;            /* bytes handed out as separate allocations */
+    size_t high_water;          /* size the arena grows to once idle */
+    int trim_pending;
+} scratchpad_arena;
+
+static pthread_mutex_t arenas_lock = PTHREAD_MUTEX_INITIALIZER;
+static scratchpad_arena* arenas;
+static pthread_key_t arena_key;
+static pthread_once_t arena_key_once = PTHREAD_ONCE_INIT;
+static __thread scratchpad_arena* current;
+static __thread int failed;
+static volatile int huge_pages;
+
+void scratchpad_set_huge_pages(int enable)
+{
+    huge_pages = enable;
+    /* idle arenas come back with the new backing on their next hash */
+    scratchpad_trim();
+}
+
+int scratchpad_huge_pages(void)
+{
+    return huge_pages;
+}
+
+/* Huge page backed mapping, rounded up to whole huge pages in *mapped. */
+static void* huge_map(size_t size, size_t* mapped, int* pages)
+{
+    uint8_t *raw, *aligned;
+
+    size = HUGE_PAGE_ROUND(size);
+
+#ifdef MAP_HUGETLB
+    aligned = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (aligned != MAP_FAILED) {
+        *mapped = size;
+        *pages = SCRATCHPAD_PAGES_HUGE;
+        return aligned;
+    }
+#endif
+
+    /* no reserved huge pages, ask for transparent ones on a huge page aligned range */
+    raw = mmap(NULL, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return NULL;
+
+    aligned = (uint8_t*)HUGE_PAGE_ROUND((uintptr_t)raw);
+    if (aligned > raw)
+        munmap(raw, aligned - raw);
+    if (raw + HUGE_PAGE_SIZE > aligned)
+        munmap(aligned + size, raw + HUGE_PAGE_SIZE - aligned);
+
+    *mapped = size;
+    *pages = SCRATCHPAD_PAGES_SMALL;
+#ifdef MADV_HUGEPAGE
+    if (madvise(aligned, size, MADV_HUGEPAGE) == 0)
+        *pages = SCRATCHPAD_PAGES_TRANSPARENT;
+#endif
+    return aligned;
+}
+
+static void huge_unmap(void* ptr, size_t mapped)
+{
+    munmap(ptr, mapped);
+}
+
+static void* region_alloc(size_t size, size_t* mapped, int* pages)
+{
+    void* ptr;
+
+    if (huge_pages && size >= HUGE_PAGE_THRESHOLD) {
+        ptr = huge_map(size, mapped, pages);
+        if (ptr != NULL)
+            return ptr;
+    }
+
+    *mapped = 0;
+    *pages = SCRATCHPAD_PAGES_SMALL;
+    if (posix_memalign(&ptr, SCRATCHPAD_ALIGN, size) != 0)
+        return NULL;
+    return ptr;
+}
+
+static void region_free(void* ptr, size_t mapped)
+{
+    if (mapped != 0)
+        huge_unmap(ptr, mapped);
+    else
+        free(ptr);
+}
+
+/* Called with arena->lock held and nothing handed out. */
+static void arena_drop(scratchpad_arena* arena)
+{
+    if (arena->base != NULL)
+        region_free(arena->base, arena->mapped);
+    arena->base = NULL;
+    arena->size = 0;
+    arena->mapped = 0;
+    arena->pages = SCRATCHPAD_PAGES_SMALL;
+    arena->high_water = 0;
+    arena->trim_pending = 0;
+}
+
+static void arena_destroy(void* ptr)
+{
+    scratchpad_arena* arena = ptr;
+
+    pthread_mutex_lock(&arenas_lock);
+    if (arena->prev != NULL)
+        arena->prev->next = arena->next;
+    else
+        arenas = arena->next;
+    if (arena->next != NULL)
+        arena->next->prev = arena->prev;
+    pthread_mutex_unlock(&arenas_lock);
+
+    arena_drop(arena);
+    pthread_mutex_destroy(&arena->lock);
+    free(arena);
+}
+
+static void arena_key_create(void)
+{
+    pthread_key_create(&arena_key, arena_destroy);
+}
+
+static scratchpad_arena* arena_get(void)
+{
+    scratchpad_arena* arena = current;
+
+    if (arena != NULL)
+        return arena;
+
+    arena = calloc(1, sizeof(*arena));
+    if (arena == NULL)
+        return NULL;
+    pthread_mutex_init(&arena->lock, NULL);
+
+    pthread_once(&arena_key_once, arena_key_create);
+    pthread_setspecific(arena_key, arena);
+
+    pthread_mutex_lock(&arenas_lock);
+    arena->next = arenas;
+    if (arenas != NULL)
+        arenas->prev = arena;
+    arenas = arena;
+    pthread_mutex_unlock(&arenas_lock);
+
+    current = arena;
+    return arena;
+}
+
+void* scratchpad_acquire(size_t size)
+{
+    scratchpad_arena* arena = arena_get();
+    uint8_t* ptr;
+    scratchpad_header header;
+    size_t need, grow, mapped;
+    int pages;
+
+    if (arena == NULL) {
+        failed = 1;
+        return NULL;
+    }
+
+    size = SCRATCHPAD_ROUND(size);
+
+    pthread_mutex_lock(&arena->lock);
+
+    need = arena->used + arena->overflow + size;
+    grow = need > arena->high_water ? need : arena->high_water;
+
+    /* grow only while idle so nothing handed out ever moves, and keep the
+       old arena when the larger one cannot be had */
+    if (arena->used == 0 && arena->overflow == 0 && arena->size < grow) {
+        ptr = region_alloc(grow, &mapped, &pages);
+        if (ptr != NULL) {
+            if (arena->base != NULL)
+                region_free(arena->base, arena->mapped);
+            arena->base = ptr;
+            arena->size = grow;
+            arena->mapped = mapped;
+            arena->pages = pages;
+        }
+    }
+
+    if (arena->used + size <= arena->size) {
+        ptr = arena->base + arena->used;
+        arena->used += size;
+    } else {
+        /* does not fit beside an outer request, the header keeps its size */
+        ptr = region_alloc(size + SCRATCHPAD_ALIGN, &header.mapped, &header.pages);
+        if (ptr != NULL) {
+            header.size = size;
+            *(scratchpad_header*)ptr = header;
+            ptr += SCRATCHPAD_ALIGN;
+            arena->overflow += size;
+        }
+    }
+
+    /* a request that failed must not make every later one try again */
+    if (ptr != NULL && need > arena->high_water)
+        arena->high_water = need;
+
+    pthread_mutex_unlock(&arena->lock);
+
+    if (ptr == NULL)
+        failed = 1;
+    return ptr;
+}
+
+int scratchpad_failed(void)
+{
+    int result = failed;
+
+    failed = 0;
+    return result;
+}
+
+void scratchpad_release(void* ptr)
+{
+    scratchpad_arena* arena = current;
+    uint8_t* p = ptr;
+    scratchpad_header header;
+
+    if (p == NULL || arena == NULL)
+        return;
+
+    pthread_mutex_lock(&arena->lock);
+
+    if (p >= arena->base && p < arena->base + arena->size) {
+        arena->used = p - arena->base;
+    } else {
+        p -= SCRATCHPAD_ALIGN;
+        header = *(scratchpad_header*)p;
+        region_free(p, header.mapped);
+        arena->overflow -= header.size;
+    }
+
+    if (arena->trim_pending && arena->used == 0 && arena->overflow == 0)
+        arena_drop(arena);
+
+    pthread_mutex_unlock(&arena->lock);
+}
+
+void scratchpad_trim(void)
+{
+    scratchpad_arena* arena;
+
+    pthread_mutex_lock(&arenas_lock);
+    for (arena = arenas; arena != NULL; arena = arena->next) {
+        pthread_mutex_lock(&arena->lock);
+        if (arena->used == 0 && arena->overflow == 0)
+            arena_drop(arena);
+        else
+            arena->trim_pending = 1;
+        pthread_mutex_unlock(&arena->lock);
+    }
+    pthread_mutex_unlock(&arenas_lock);
+}
+
+void scratchpad_shrink(size_t bytes)
+{
+    scratchpad_arena* self = current;
+    scratchpad_arena* arena;
+    size_t reserved = 0, slack = 0;
+
+    if (self == NULL)
+        return;
+
+    pthread_mutex_lock(&arenas_lock);
+    for (arena = arenas; arena != NULL; arena = arena->next) {
+        pthread_mutex_lock(&arena->lock);
+        reserved += arena->size + arena->overflow;
+        /* each arena rounds its requests up, which bytes need not allow for */
+        slack += SCRATCHPAD_ALIGN;
+        pthread_mutex_unlock(&arena->lock);
+    }
+
+    pthread_mutex_lock(&self->lock);
+    if (self->used == 0 && self->overflow == 0 && reserved > bytes && reserved - bytes >= slack)
+        arena_drop(self);
+    pthread_mutex_unlock(&self->lock);
+    pthread_mutex_unlock(&arenas_lock);
+}
+
+void scratchpad_stats(scratchpad_stats_t* stats)
+{
+    scratchpad_arena* arena;
+
+    stats->threads = 0;
+    stats->reserved = 0;
+    stats->in_use = 0;
+    stats->huge_pages = 0;
+    stats->transparent_huge_pages = 0;
+
+    pthread_mutex_lock(&arenas_lock);
+    for (arena = arenas; arena != NULL; arena = arena->next) {
+        pthread_mutex_lock(&arena->lock);
+        stats->threads++;
+        stats->reserved += arena->size + arena->overflow;
+        stats->in_use += arena->used + arena->overflow;
+        if (arena->pages == SCRATCHPAD_PAGES_HUGE)
+            stats->huge_pages += arena->mapped;
+        else if (arena->pages == SCRATCHPAD_PAGES_TRANSPARENT)
+            stats->transparent_huge_pages += arena->mapped;
+        pthread_mutex_unlock(&arena->lock);
+    }
+    pthread_mutex_unlock(&arenas_lock);
+}
@@ -0,0 +1,63 @@
+#ifndef SCRATCHPAD_H
+#define SCRATCHPAD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+/*
+ * Per-thread scratch memory for the memory-hard hashes.  Each thread keeps
+ * one 64-byte aligned arena that grows to the largest request it has seen
+ * and is reused by every following hash instead of going back to the heap.
+ *
+ * Acquire/release pairs must nest (last acquired, first released).  A request
+ * that does not fit while an outer one is held gets its own allocation and
+ * the arena grows to cover both once it is idle again.
+ */
+void* scratchpad_acquire(size_t size);
+void scratchpad_release(void* ptr);
+
+/*
+ * scratchpad_acquire() returns NULL when the memory cannot be had; the hash
+ * then zeroes its output and returns. This is non-zero if that happened on
+ * the calling thread since the last call, and clears it, so the caller of
+ * the hash can report the error instead of a digest.
+ */
+int scratchpad_failed(void);
+
+/* Frees the arenas of all threads that are not hashing right now. */
+void scratchpad_trim(void);
+
+/* Frees the calling thread's arena if it is idle and all arenas together hold more than bytes. */
+void scratchpad_shrink(size_t bytes);
+
+/*
+ * Huge pages are off by default.  When enabled, arenas of 1 MiB and more are
+ * mapped with MAP_HUGETLB, or failing that (no pages reserved in
+ * /proc/sys/vm/nr_hugepages) aligned and madvise()d for transparent huge
+ * pages.  Changing the setting trims the idle arenas.
+ */
+void scratchpad_set_huge_pages(int enable);
+int scratchpad_huge_pages(void);
+
+/*
+ * Only arena memory is counted. yescrypt keeps its own per-thread region,
+ * which follows scratchpad_huge_pages() but is not included here.
+ */
+typedef struct {
+    size_t threads;                 /* threads that own an arena */
+    size_t reserved;                /* bytes held by all arenas */
+    size_t in_use;                  /* bytes of those handed out right now */
+    size_t huge_pages;              /* arena bytes on MAP_HUGETLB pages */
+    size_t transparent_huge_pages;  /* arena bytes madvise()d for THP */
+} scratchpad_stats_t;
+
+void scratchpad_stats(scratchpad_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -34,6 +34,8 @@
 
 #include "scryptn.h"
 #include "sha256.h"
+#include "scratchpad.h"
+#include "algorithms.h"
 
 static void blkcpy(void *, void *, size_t);
 static void blkxor(void *, void *, size_t);
@@ -218,7 +220,7 @@ smix(uint8_t * B, size_t r, uint64_t N, uint32_t * V, uint32_t * XY)
 /* cpu and memory intensive function to transform a 80 byte buffer into a 32 byte output
    scratchpad size needs to be at least 63 + (128 * r * p) + (256 * r + 64) + (128 * r * N) bytes
  */
-void scrypt_N_R_1_256_sp(const char* input, char* output, char* scratchpad, uint32_t N, uint32_t R, uint32_t len)
+static void scrypt_N_R_1_256_core(const uint8_t* passwd, size_t passwdlen, const char* input, char* output, char* scratchpad, uint32_t N, uint32_t R, uint32_t len)
 {
 	uint8_t * B;
 	uint32_t * V;
@@ -234,7 +236,7 @@ void scrypt_N_R_1_256_sp(const char* input, char* output, char* scratchpad, uint
 	V = (uint32_t *)(B + (128 * r * p) + (256 * r + 64));
 
 	/* 1: (B_0 ... B_{p-1}) <-- PBKDF2(P, S, 1, p * MFLen) */
-	PBKDF2_SHA256((const uint8_t*)input, len, (const uint8_t*)input, len, 1, B, p * 128 * r);
+	PBKDF2_SHA256(passwd, passwdlen, (const uint8_t*)input, len, 1, B, p * 128 * r);
 
 	/* 2: for i = 0 to p - 1 do */
 	for (i = 0; i < p; i++) {
@@ -243,7 +245,12 @@ void scrypt_N_R_1_256_sp(const char* input, char* output, char* scratchpad, uint
 	}
 
 	/* 5: DK <-- PBKDF2(P, B, 1, dkLen) */
-	PBKDF2_SHA256((const uint8_t*)input, len, B, p * 128 * r, 1, (uint8_t*)output, 32);
+	PBKDF2_SHA256(passwd, passwdlen, B, p * 128 * r, 1, (uint8_t*)output, 32);
+}
+
+void scrypt_N_R_1_256_sp(const char* input, char* output, char* scratchpad, uint32_t N, uint32_t R, uint32_t len)
+{
+	scrypt_N_R_1_256_core((const uint8_t*)input, len, input, output, scratchpad, N, R, len);
 }
 
 void scrypt_N_R_1_256(const char* input, char* output, uint32_t N, uint32_t R, uint32_t len)
@@ -252,7 +259,39 @@ void scrypt_N_R_1_256(const char* input, char* output, uint32_t N, uint32_t R, u
     char *scratchpad;
     
     // align on 4 byte boundary
-    scratchpad = (char*)malloc(128*N*R + (128*R)+(256*R)+64+64);
+    scratchpad = (char*)scratchpad_acquire((size_t)128*N*R + (128*R)+(256*R)+64+64);
+    if (scratchpad == NULL) {
+        memset(output, 0, 32);
+        return;
+    }
 	scrypt_N_R_1_256_sp(input, output, scratchpad, N, R, len);
-    free(scratchpad);
+    scratchpad_release(scratchpad);
+}
+
+/* The 80 byte header is longer than a SHA-256 block, so HMAC keys itself
+   with SHA256(header); the prepared state is that hash over the first 76 bytes. */
+typedef char prepared_state_fits[sizeof(SHA256_CTX) <= ALGORITHM_PREPARED_SIZE ? 1 : -1];
+
+void scrypt_N_R_1_256_prepare(void* state, const char* header)
+{
+	SHA256_Init(state);
+	SHA256_Update(state, header, 76);
+}
+
+void scrypt_N_R_1_256_nonce(const void* state, const char* header, char* output, uint32_t N, uint32_t R)
+{
+	SHA256_CTX ctx = *(const SHA256_CTX*)state;
+	uint8_t key[32];
+	char *scratchpad;
+
+	SHA256_Update(&ctx, header + 76, 4);
+	SHA256_Final(key, &ctx);
+
+	scratchpad = (char*)scratchpad_acquire((size_t)128*N*R + (128*R)+(256*R)+64+64);
+	if (scratchpad == NULL) {
+		memset(output, 0, 32);
+		return;
+	}
+	scrypt_N_R_1_256_core(key, 32, header, output, scratchpad, N, R, 80);
+	scratchpad_release(scratchpad);
 }
@@ -7,6 +7,10 @@ extern "C" {
 
 void scrypt_N_R_1_256(const char* input, char* output, uint32_t N, uint32_t R, uint32_t len);
 void scrypt_N_R_1_256_sp(const char* input, char* output, char* scratchpad, uint32_t N, uint32_t R, uint32_t len);
+
+/* nonce-only hashing of 80 byte headers, state being a SHA256_CTX */
+void scrypt_N_R_1_256_prepare(void* state, const char* header);
+void scrypt_N_R_1_256_nonce(const void* state, const char* header, char* output, uint32_t N, uint32_t R);
 //const int scrypt_scratchpad_size = 131583;
 
 #ifdef __cplusplus
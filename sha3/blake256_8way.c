@@ -0,0 +1,320 @@
+#include "blake256_8way.h"
+#include <string.h>
+#include "../cpu.h"
+#include "sph_types.h"
+
+#ifdef CPU_X86
+#include <immintrin.h>
+#endif
+
+static const uint32_t IV256[8] = {
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+    0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+};
+
+static const uint32_t CS[16] = {
+    0x243F6A88, 0x85A308D3, 0x13198A2E, 0x03707344,
+    0xA4093822, 0x299F31D0, 0x082EFA98, 0xEC4E6C89,
+    0x452821E6, 0x38D01377, 0xBE5466CF, 0x34E90C6C,
+    0xC0AC29B7, 0xC97C50DD, 0x3F84D5B5, 0xB5470917
+};
+
+static const unsigned char sigma[10][16] = {
+    {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+    { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+    { 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+    {  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+    {  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+    {  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+    { 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+    { 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+    {  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+    { 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 }
+};
+
+/* the second block of an 80 byte header after its padding, words 4 to 15 */
+#define PAD80_M4    0x80000000
+#define PAD80_M13   0x00000001
+#define PAD80_M15   640
+
+#define ROTR32(x, n)    (((x) >> (n)) | ((x) << (32 - (n))))
+
+#define G(a, b, c, d, m0, m1, c0, c1)   do { \
+        a += b + (m0 ^ c1); \
+        d = ROTR32(d ^ a, 16); \
+        c += d; \
+        b = ROTR32(b ^ c, 12); \
+        a += b + (m1 ^ c0); \
+        d = ROTR32(d ^ a, 8); \
+        c += d; \
+        b = ROTR32(b ^ c, 7); \
+    } while (0)
+
+/* M[word][lane], counters in bits */
+static void compress_lanes(uint32_t H[8][8], uint32_t M[16][8], uint32_t T0, uint32_t T1, unsigned rounds)
+{
+    unsigned lane, r;
+    int i;
+
+    for (lane = 0; lane < 8; lane++) {
+        uint32_t v[16];
+
+        for (i = 0; i < 8; i++)
+            v[i] = H[i][lane];
+        for (i = 0; i < 4; i++)
+            v[8 + i] = CS[i];
+        v[12] = T0 ^ CS[4];
+        v[13] = T0 ^ CS[5];
+        v[14] = T1 ^ CS[6];
+        v[15] = T1 ^ CS[7];
+
+        for (r = 0; r < rounds; r++) {
+            const unsigned char *s = sigma[r % 10];
+
+            G(v[0], v[4], v[ 8], v[12], M[s[ 0]][lane], M[s[ 1]][lane], CS[s[ 0]], CS[s[ 1]]);
+            G(v[1], v[5], v[ 9], v[13], M[s[ 2]][lane], M[s[ 3]][lane], CS[s[ 2]], CS[s[ 3]]);
+            G(v[2], v[6], v[10], v[14], M[s[ 4]][lane], M[s[ 5]][lane], CS[s[ 4]], CS[s[ 5]]);
+            G(v[3], v[7], v[11], v[15], M[s[ 6]][lane], M[s[ 7]][lane], CS[s[ 6]], CS[s[ 7]]);
+            G(v[0], v[5], v[10], v[15], M[s[ 8]][lane], M[s[ 9]][lane], CS[s[ 8]], CS[s[ 9]]);
+            G(v[1], v[6], v[11], v[12], M[s[10]][lane], M[s[11]][lane], CS[s[10]], CS[s[11]]);
+            G(v[2], v[7], v[ 8], v[13], M[s[12]][lane], M[s[13]][lane], CS[s[12]], CS[s[13]]);
+            G(v[3], v[4], v[ 9], v[14], M[s[14]][lane], M[s[15]][lane], CS[s[14]], CS[s[15]]);
+        }
+
+        for (i = 0; i < 8; i++)
+            H[i][lane] ^= v[i] ^ v[i + 8];
+    }
+}
+
+#ifdef CPU_X86
+
+#define AVX2 CPU_TARGET("avx2")
+
+#define ROTR32_16(x)    _mm256_shuffle_epi8(x, rot16)
+#define ROTR32_8(x)     _mm256_shuffle_epi8(x, rot8)
+#define ROTR32_N(x, n)  _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+#define G8(a, b, c, d, i0, i1)   do { \
+        a = _mm256_add_epi32(a, _mm256_add_epi32(b, _mm256_xor_si256(m[i0], _mm256_set1_epi32(CS[i1])))); \
+        d = ROTR32_16(_mm256_xor_si256(d, a)); \
+        c = _mm256_add_epi32(c, d); \
+        b = ROTR32_N(_mm256_xor_si256(b, c), 12); \
+        a = _mm256_add_epi32(a, _mm256_add_epi32(b, _mm256_xor_si256(m[i1], _mm256_set1_epi32(CS[i0])))); \
+        d = ROTR32_8(_mm256_xor_si256(d, a)); \
+        c = _mm256_add_epi32(c, d); \
+        b = ROTR32_N(_mm256_xor_si256(b, c), 7); \
+    } while (0)
+
+#define ROUND8(r)   do { \
+        G8(v[0], v[4], v[ 8], v[12], sigma[r][ 0], sigma[r][ 1]); \
+        G8(v[1], v[5], v[ 9], v[13], sigma[r][ 2], sigma[r][ 3]); \
+        G8(v[2], v[6], v[10], v[14], sigma[r][ 4], sigma[r][ 5]); \
+        G8(v[3], v[7], v[11], v[15], sigma[r][ 6], sigma[r][ 7]); \
+        G8(v[0], v[5], v[10], v[15], sigma[r][ 8], sigma[r][ 9]); \
+        G8(v[1], v[6], v[11], v[12], sigma[r][10], sigma[r][11]); \
+        G8(v[2], v[7], v[ 8], v[13], sigma[r][12], sigma[r][13]); \
+        G8(v[3], v[4], v[ 9], v[14], sigma[r][14], sigma[r][15]); \
+    } while (0)
+
+AVX2 static void compress_avx2(uint32_t H[8][8], uint32_t M[16][8], uint32_t T0, uint32_t T1, unsigned rounds)
+{
+    const __m256i rot16 = _mm256_setr_epi8(
+        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m256i rot8 = _mm256_setr_epi8(
+        1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12,
+        1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+    __m256i m[16], v[16];
+    int i;
+
+    for (i = 0; i < 16; i++)
+        m[i] = _mm256_loadu_si256((const __m256i*) M[i]);
+    for (i = 0; i < 8; i++)
+        v[i] = _mm256_loadu_si256((const __m256i*) H[i]);
+    for (i = 0; i < 4; i++)
+        v[8 + i] = _mm256_set1_epi32(CS[i]);
+    v[12] = _mm256_set1_epi32(T0 ^ CS[4]);
+    v[13] = _mm256_set1_epi32(T0 ^ CS[5]);
+    v[14] = _mm256_set1_epi32(T1 ^ CS[6]);
+    v[15] = _mm256_set1_epi32(T1 ^ CS[7]);
+
+    /* unrolled, so the sigma indices are constants */
+    ROUND8(0); ROUND8(1); ROUND8(2); ROUND8(3);
+    ROUND8(4); ROUND8(5); ROUND8(6); ROUND8(7);
+    if (rounds > 8) {
+        ROUND8(8); ROUND8(9); ROUND8(0); ROUND8(1);
+        ROUND8(2); ROUND8(3);
+    }
+
+    for (i = 0; i < 8; i++) {
+        __m256i h = _mm256_loadu_si256((const __m256i*) H[i]);
+
+        h = _mm256_xor_si256(h, _mm256_xor_si256(v[i], v[i + 8]));
+        _mm256_storeu_si256((__m256i*) H[i], h);
+    }
+}
+
+#endif
+
+static void compress(uint32_t H[8][8], uint32_t M[16][8], uint32_t T0, uint32_t T1, unsigned rounds)
+{
+#ifdef CPU_X86
+    if (cpu_features() & CPU_FEATURE_AVX2) {
+        compress_avx2(H, M, T0, T1, rounds);
+        return;
+    }
+#endif
+    compress_lanes(H, M, T0, T1, rounds);
+}
+
+int blake256_8way_available(void)
+{
+#ifdef CPU_X86
+    return (cpu_features() & CPU_FEATURE_AVX2) != 0;
+#else
+    return 0;
+#endif
+}
+
+static void init(blake256_8way_context *ctx, unsigned rounds)
+{
+    int i, lane;
+
+    for (i = 0; i < 8; i++)
+        for (lane = 0; lane < 8; lane++)
+            ctx->H[i][lane] = IV256[i];
+    ctx->ptr = 0;
+    ctx->T0 = ctx->T1 = 0;
+    ctx->rounds = rounds;
+}
+
+void blake256_8way_init(blake256_8way_context *ctx)
+{
+    init(ctx, 14);
+}
+
+void blake256r8_8way_init(blake256_8way_context *ctx)
+{
+    init(ctx, 8);
+}
+
+static void compress_buffers(blake256_8way_context *ctx)
+{
+    uint32_t M[16][8];
+    int i, lane;
+
+    for (i = 0; i < 16; i++)
+        for (lane = 0; lane < 8; lane++)
+            M[i][lane] = sph_dec32be(ctx->buf[lane] + 4 * i);
+    compress(ctx->H, M, ctx->T0, ctx->T1, ctx->rounds);
+}
+
+void blake256_8way_update(blake256_8way_context *ctx, const void *const data[8], size_t len)
+{
+    size_t done = 0;
+    int lane;
+
+    while (done < len) {
+        size_t clen = sizeof ctx->buf[0] - ctx->ptr;
+
+        if (clen > len - done)
+            clen = len - done;
+        for (lane = 0; lane < 8; lane++)
+            memcpy(ctx->buf[lane] + ctx->ptr, (const unsigned char*) data[lane] + done, clen);
+        ctx->ptr += clen;
+        done += clen;
+
+        if (ctx->ptr == sizeof ctx->buf[0]) {
+            if ((ctx->T0 += 512) < 512)
+                ctx->T1++;
+            compress_buffers(ctx);
+            ctx->ptr = 0;
+        }
+    }
+}
+
+/* the padding of sph_blake256_close(), the same for every lane */
+void blake256_8way_close(blake256_8way_context *ctx, void *const dst[8])
+{
+    unsigned char pad[64];
+    const void *pads[8] = { pad, pad, pad, pad, pad, pad, pad, pad };
+    size_t ptr = ctx->ptr;
+    unsigned bit_len = (unsigned) ptr << 3;
+    uint32_t th = ctx->T1, tl = ctx->T0 + bit_len;
+    int i, lane;
+
+    memset(pad, 0, sizeof pad);
+    pad[0] = 0x80;
+
+    if (ptr == 0) {
+        ctx->T0 = 0xFFFFFE00;
+        ctx->T1 = 0xFFFFFFFF;
+    } else if (ctx->T0 == 0) {
+        ctx->T0 = 0xFFFFFE00 + bit_len;
+        ctx->T1--;
+    } else {
+        ctx->T0 -= 512 - bit_len;
+    }
+
+    if (bit_len <= 446) {
+        pad[55 - ptr] |= 1;
+        sph_enc32be(pad + 56 - ptr, th);
+        sph_enc32be(pad + 60 - ptr, tl);
+        blake256_8way_update(ctx, pads, 64 - ptr);
+    } else {
+        blake256_8way_update(ctx, pads, 64 - ptr);
+        ctx->T0 = 0xFFFFFE00;
+        ctx->T1 = 0xFFFFFFFF;
+        memset(pad, 0, sizeof pad);
+        pad[55] = 1;
+        sph_enc32be(pad + 56, th);
+        sph_enc32be(pad + 60, tl);
+        blake256_8way_update(ctx, pads, 64);
+    }
+
+    for (lane = 0; lane < 8; lane++)
+        for (i = 0; i < 8; i++)
+            sph_enc32be((unsigned char*) dst[lane] + 4 * i, ctx->H[i][lane]);
+}
+
+static void hash80(const void *const data[8], void *const dst[8], unsigned rounds)
+{
+    uint32_t H[8][8], M[16][8];
+    int i, lane;
+
+    for (lane = 0; lane < 8; lane++) {
+        for (i = 0; i < 8; i++)
+            H[i][lane] = IV256[i];
+        for (i = 0; i < 16; i++)
+            M[i][lane] = sph_dec32be((const unsigned char*) data[lane] + 4 * i);
+    }
+
+    compress(H, M, 512, 0, rounds);
+
+    for (lane = 0; lane < 8; lane++) {
+        for (i = 0; i < 4; i++)
+            M[i][lane] = sph_dec32be((const unsigned char*) data[lane] + 64 + 4 * i);
+        M[4][lane] = PAD80_M4;
+        for (i = 5; i < 13; i++)
+            M[i][lane] = 0;
+        M[13][lane] = PAD80_M13;
+        M[14][lane] = 0;
+        M[15][lane] = PAD80_M15;
+    }
+
+    compress(H, M, 640, 0, rounds);
+
+    for (lane = 0; lane < 8; lane++)
+        for (i = 0; i < 8; i++)
+            sph_enc32be((unsigned char*) dst[lane] + 4 * i, H[i][lane]);
+}
+
+void blake256_8way_80(const void *const data[8], void *const dst[8])
+{
+    hash80(data, dst, 14);
+}
+
+void blake256r8_8way_80(const void *const data[8], void *const dst[8])
+{
+    hash80(data, dst, 8);
+}
@@ -0,0 +1,41 @@
+#ifndef BLAKE256_8WAY_H
+#define BLAKE256_8WAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Eight independent BLAKE-256 hashes at once, one per 32-bit lane of an AVX2
+ * register, with the standard 14 rounds (sph_blake256) or the 8 rounds of
+ * Blakecoin and its forks. All eight inputs must have the same length.
+ * Without AVX2 the lanes are hashed one after another with the same results.
+ */
+typedef struct {
+    uint32_t H[8][8];           /* chaining value, word-major: H[word][lane] */
+    unsigned char buf[8][64];
+    size_t ptr;
+    uint32_t T0, T1;
+    unsigned rounds;
+} blake256_8way_context;
+
+/* Non-zero when the AVX2 kernel is used. */
+int blake256_8way_available(void);
+
+void blake256_8way_init(blake256_8way_context *ctx);
+void blake256r8_8way_init(blake256_8way_context *ctx);
+void blake256_8way_update(blake256_8way_context *ctx, const void *const data[8], size_t len);
+void blake256_8way_close(blake256_8way_context *ctx, void *const dst[8]);
+
+/* One-shot hashes of eight 80 byte block headers into eight 32 byte digests. */
+void blake256_8way_80(const void *const data[8], void *const dst[8]);
+void blake256r8_8way_80(const void *const data[8], void *const dst[8]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
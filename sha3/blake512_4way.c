@@ -0,0 +1,337 @@
+#include "blake512_4way.h"
+#include <string.h>
+#include "../cpu.h"
+#include "sph_types.h"
+#include "sph_blake.h"
+
+#ifdef CPU_X86
+#include <immintrin.h>
+#endif
+
+static const uint64_t IV512[8] = {
+    0x6A09E667F3BCC908ULL, 0xBB67AE8584CAA73BULL,
+    0x3C6EF372FE94F82BULL, 0xA54FF53A5F1D36F1ULL,
+    0x510E527FADE682D1ULL, 0x9B05688C2B3E6C1FULL,
+    0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL
+};
+
+static const uint64_t CB[16] = {
+    0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL,
+    0xA4093822299F31D0ULL, 0x082EFA98EC4E6C89ULL,
+    0x452821E638D01377ULL, 0xBE5466CF34E90C6CULL,
+    0xC0AC29B7C97C50DDULL, 0x3F84D5B5B5470917ULL,
+    0x9216D5D98979FB1BULL, 0xD1310BA698DFB5ACULL,
+    0x2FFD72DBD01ADFB7ULL, 0xB8E1AFED6A267E96ULL,
+    0xBA7C9045F12C7F99ULL, 0x24A19947B3916CF7ULL,
+    0x0801F2E2858EFC16ULL, 0x636920D871574E69ULL
+};
+
+static const unsigned char sigma[10][16] = {
+    {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+    { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+    { 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+    {  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+    {  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+    {  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+    { 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+    { 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+    {  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+    { 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 }
+};
+
+/* the 80 byte header block after its padding, message words 10 to 15 */
+#define PAD80_M10   0x8000000000000000ULL
+#define PAD80_M13   0x0000000000000001ULL
+#define PAD80_M15   640
+
+#define ROTR64(x, n)    (((x) >> (n)) | ((x) << (64 - (n))))
+
+#define G(a, b, c, d, m0, m1, c0, c1)   do { \
+        a += b + (m0 ^ c1); \
+        d = ROTR64(d ^ a, 32); \
+        c += d; \
+        b = ROTR64(b ^ c, 25); \
+        a += b + (m1 ^ c0); \
+        d = ROTR64(d ^ a, 16); \
+        c += d; \
+        b = ROTR64(b ^ c, 11); \
+    } while (0)
+
+/* M[word][lane], counters in bits */
+static void compress_lanes(uint64_t H[8][4], uint64_t M[16][4], uint64_t T0, uint64_t T1)
+{
+    int lane, r, i;
+
+    for (lane = 0; lane < 4; lane++) {
+        uint64_t v[16];
+
+        for (i = 0; i < 8; i++)
+            v[i] = H[i][lane];
+        for (i = 0; i < 4; i++)
+            v[8 + i] = CB[i];
+        v[12] = T0 ^ CB[4];
+        v[13] = T0 ^ CB[5];
+        v[14] = T1 ^ CB[6];
+        v[15] = T1 ^ CB[7];
+
+        for (r = 0; r < 16; r++) {
+            const unsigned char *s = sigma[r % 10];
+
+            G(v[0], v[4], v[ 8], v[12], M[s[ 0]][lane], M[s[ 1]][lane], CB[s[ 0]], CB[s[ 1]]);
+            G(v[1], v[5], v[ 9], v[13], M[s[ 2]][lane], M[s[ 3]][lane], CB[s[ 2]], CB[s[ 3]]);
+            G(v[2], v[6], v[10], v[14], M[s[ 4]][lane], M[s[ 5]][lane], CB[s[ 4]], CB[s[ 5]]);
+            G(v[3], v[7], v[11], v[15], M[s[ 6]][lane], M[s[ 7]][lane], CB[s[ 6]], CB[s[ 7]]);
+            G(v[0], v[5], v[10], v[15], M[s[ 8]][lane], M[s[ 9]][lane], CB[s[ 8]], CB[s[ 9]]);
+            G(v[1], v[6], v[11], v[12], M[s[10]][lane], M[s[11]][lane], CB[s[10]], CB[s[11]]);
+            G(v[2], v[7], v[ 8], v[13], M[s[12]][lane], M[s[13]][lane], CB[s[12]], CB[s[13]]);
+            G(v[3], v[4], v[ 9], v[14], M[s[14]][lane], M[s[15]][lane], CB[s[14]], CB[s[15]]);
+        }
+
+        for (i = 0; i < 8; i++)
+            H[i][lane] ^= v[i] ^ v[i + 8];
+    }
+}
+
+#ifdef CPU_X86
+
+#define AVX2 CPU_TARGET("avx2")
+
+#define ROTR64_32(x)    _mm256_shuffle_epi32(x, 0xB1)
+#define ROTR64_16(x)    _mm256_shuffle_epi8(x, rot16)
+#define ROTR64_N(x, n)  _mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - (n)))
+
+#define G4(a, b, c, d, i0, i1)   do { \
+        a = _mm256_add_epi64(a, _mm256_add_epi64(b, _mm256_xor_si256(m[i0], _mm256_set1_epi64x(CB[i1])))); \
+        d = ROTR64_32(_mm256_xor_si256(d, a)); \
+        c = _mm256_add_epi64(c, d); \
+        b = ROTR64_N(_mm256_xor_si256(b, c), 25); \
+        a = _mm256_add_epi64(a, _mm256_add_epi64(b, _mm256_xor_si256(m[i1], _mm256_set1_epi64x(CB[i0])))); \
+        d = ROTR64_16(_mm256_xor_si256(d, a)); \
+        c = _mm256_add_epi64(c, d); \
+        b = ROTR64_N(_mm256_xor_si256(b, c), 11); \
+    } while (0)
+
+#define ROUND4(r)   do { \
+        G4(v[0], v[4], v[ 8], v[12], sigma[r][ 0], sigma[r][ 1]); \
+        G4(v[1], v[5], v[ 9], v[13], sigma[r][ 2], sigma[r][ 3]); \
+        G4(v[2], v[6], v[10], v[14], sigma[r][ 4], sigma[r][ 5]); \
+        G4(v[3], v[7], v[11], v[15], sigma[r][ 6], sigma[r][ 7]); \
+        G4(v[0], v[5], v[10], v[15], sigma[r][ 8], sigma[r][ 9]); \
+        G4(v[1], v[6], v[11], v[12], sigma[r][10], sigma[r][11]); \
+        G4(v[2], v[7], v[ 8], v[13], sigma[r][12], sigma[r][13]); \
+        G4(v[3], v[4], v[ 9], v[14], sigma[r][14], sigma[r][15]); \
+    } while (0)
+
+AVX2 static void compress_avx2(uint64_t H[8][4], uint64_t M[16][4], uint64_t T0, uint64_t T1)
+{
+    const __m256i rot16 = _mm256_setr_epi8(
+        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+    __m256i m[16], v[16];
+    int i;
+
+    for (i = 0; i < 16; i++)
+        m[i] = _mm256_loadu_si256((const __m256i*) M[i]);
+    for (i = 0; i < 8; i++)
+        v[i] = _mm256_loadu_si256((const __m256i*) H[i]);
+    for (i = 0; i < 4; i++)
+        v[8 + i] = _mm256_set1_epi64x(CB[i]);
+    v[12] = _mm256_set1_epi64x(T0 ^ CB[4]);
+    v[13] = _mm256_set1_epi64x(T0 ^ CB[5]);
+    v[14] = _mm256_set1_epi64x(T1 ^ CB[6]);
+    v[15] = _mm256_set1_epi64x(T1 ^ CB[7]);
+
+    /* unrolled, so the sigma indices are constants */
+    ROUND4(0); ROUND4(1); ROUND4(2); ROUND4(3);
+    ROUND4(4); ROUND4(5); ROUND4(6); ROUND4(7);
+    ROUND4(8); ROUND4(9); ROUND4(0); ROUND4(1);
+    ROUND4(2); ROUND4(3); ROUND4(4); ROUND4(5);
+
+    for (i = 0; i < 8; i++) {
+        __m256i h = _mm256_loadu_si256((const __m256i*) H[i]);
+
+        h = _mm256_xor_si256(h, _mm256_xor_si256(v[i], v[i + 8]));
+        _mm256_storeu_si256((__m256i*) H[i], h);
+    }
+}
+
+#endif
+
+static void compress(uint64_t H[8][4], uint64_t M[16][4], uint64_t T0, uint64_t T1)
+{
+#ifdef CPU_X86
+    if (cpu_features() & CPU_FEATURE_AVX2) {
+        compress_avx2(H, M, T0, T1);
+        return;
+    }
+#endif
+    compress_lanes(H, M, T0, T1);
+}
+
+int blake512_4way_available(void)
+{
+#ifdef CPU_X86
+    return (cpu_features() & CPU_FEATURE_AVX2) != 0;
+#else
+    return 0;
+#endif
+}
+
+void blake512_4way_init(blake512_4way_context *ctx)
+{
+    int i, lane;
+
+    for (i = 0; i < 8; i++)
+        for (lane = 0; lane < 4; lane++)
+            ctx->H[i][lane] = IV512[i];
+    ctx->ptr = 0;
+    ctx->T0 = ctx->T1 = 0;
+}
+
+static void compress_buffers(blake512_4way_context *ctx)
+{
+    uint64_t M[16][4];
+    int i, lane;
+
+    for (i = 0; i < 16; i++)
+        for (lane = 0; lane < 4; lane++)
+            M[i][lane] = sph_dec64be(ctx->buf[lane] + 8 * i);
+    compress(ctx->H, M, ctx->T0, ctx->T1);
+}
+
+void blake512_4way_update(blake512_4way_context *ctx, const void *const data[4], size_t len)
+{
+    size_t done = 0;
+    int lane;
+
+    while (done < len) {
+        size_t clen = sizeof ctx->buf[0] - ctx->ptr;
+
+        if (clen > len - done)
+            clen = len - done;
+        for (lane = 0; lane < 4; lane++)
+            memcpy(ctx->buf[lane] + ctx->ptr, (const unsigned char*) data[lane] + done, clen);
+        ctx->ptr += clen;
+        done += clen;
+
+        if (ctx->ptr == sizeof ctx->buf[0]) {
+            if ((ctx->T0 += 1024) < 1024)
+                ctx->T1++;
+            compress_buffers(ctx);
+            ctx->ptr = 0;
+        }
+    }
+}
+
+/* the padding of sph_blake512_close(), the same for every lane */
+void blake512_4way_close(blake512_4way_context *ctx, void *const dst[4])
+{
+    unsigned char pad[128];
+    const void *pads[4] = { pad, pad, pad, pad };
+    size_t ptr = ctx->ptr;
+    unsigned bit_len = (unsigned) ptr << 3;
+    uint64_t th = ctx->T1, tl = ctx->T0 + bit_len;
+    int i, lane;
+
+    memset(pad, 0, sizeof pad);
+    pad[0] = 0x80;
+
+    if (ptr == 0) {
+        ctx->T0 = 0xFFFFFFFFFFFFFC00ULL;
+        ctx->T1 = 0xFFFFFFFFFFFFFFFFULL;
+    } else if (ctx->T0 == 0) {
+        ctx->T0 = 0xFFFFFFFFFFFFFC00ULL + bit_len;
+        ctx->T1--;
+    } else {
+        ctx->T0 -= 1024 - bit_len;
+    }
+
+    if (bit_len <= 894) {
+        pad[111 - ptr] |= 1;
+        sph_enc64be(pad + 112 - ptr, th);
+        sph_enc64be(pad + 120 - ptr, tl);
+        blake512_4way_update(ctx, pads, 128 - ptr);
+    } else {
+        blake512_4way_update(ctx, pads, 128 - ptr);
+        ctx->T0 = 0xFFFFFFFFFFFFFC00ULL;
+        ctx->T1 = 0xFFFFFFFFFFFFFFFFULL;
+        memset(pad, 0, sizeof pad);
+        pad[111] = 1;
+        sph_enc64be(pad + 112, th);
+        sph_enc64be(pad + 120, tl);
+        blake512_4way_update(ctx, pads, 128);
+    }
+
+    for (lane = 0; lane < 4; lane++)
+        for (i = 0; i < 8; i++)
+            sph_enc64be((unsigned char*) dst[lane] + 8 * i, ctx->H[i][lane]);
+}
+
+void blake512_4way(const void *const data[4], size_t len, void *const dst[4])
+{
+    blake512_4way_context ctx;
+
+    blake512_4way_init(&ctx);
+    blake512_4way_update(&ctx, data, len);
+    blake512_4way_close(&ctx, dst);
+}
+
+void blake512_4way_80(const void *const data[4], void *const dst[4])
+{
+    uint64_t H[8][4], M[16][4];
+    int i, lane;
+
+    for (lane = 0; lane < 4; lane++) {
+        for (i = 0; i < 8; i++)
+            H[i][lane] = IV512[i];
+        for (i = 0; i < 10; i++)
+            M[i][lane] = sph_dec64be((const unsigned char*) data[lane] + 8 * i);
+        M[10][lane] = PAD80_M10;
+        M[11][lane] = 0;
+        M[12][lane] = 0;
+        M[13][lane] = PAD80_M13;
+        M[14][lane] = 0;
+        M[15][lane] = PAD80_M15;
+    }
+
+    compress(H, M, 640, 0);
+
+    for (lane = 0; lane < 4; lane++)
+        for (i = 0; i < 8; i++)
+            sph_enc64be((unsigned char*) dst[lane] + 8 * i, H[i][lane]);
+}
+
+void blake512_4way_chain(const char *const *input, char *const *output, const uint32_t *len,
+    uint32_t count, blake512_chain_fn chain)
+{
+    uint32_t hash[4][16];
+    void *dst[4] = { hash[0], hash[1], hash[2], hash[3] };
+    sph_blake512_context ctx;
+    uint32_t i;
+
+    for (; count >= 4 && blake512_4way_available(); input += 4, output += 4, count -= 4) {
+        const void *src[4] = { input[0], input[1], input[2], input[3] };
+
+        if (len == NULL)
+            blake512_4way_80(src, dst);
+        else if (len[1] != len[0] || len[2] != len[0] || len[3] != len[0])
+            break;
+        else if (len[0] == 80)
+            blake512_4way_80(src, dst);
+        else
+            blake512_4way(src, len[0], dst);
+
+        if (len != NULL)
+            len += 4;
+
+        for (i = 0; i < 4; i++)
+            chain(hash[i], output[i]);
+    }
+
+    for (i = 0; i < count; i++) {
+        sph_blake512_init(&ctx);
+        sph_blake512(&ctx, input[i], len != NULL ? len[i] : 80);
+        sph_blake512_close(&ctx, hash[0]);
+        chain(hash[0], output[i]);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef BLAKE512_4WAY_H
+#define BLAKE512_4WAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Four independent BLAKE-512 hashes at once, one per 64-bit lane of an AVX2
+ * register. The inputs are hashed in lockstep, so all four must have the same
+ * length. Without AVX2 the same functions run the lanes one after another,
+ * and the digests are identical to sph_blake512's either way.
+ */
+typedef struct {
+    uint64_t H[8][4];           /* chaining value, word-major: H[word][lane] */
+    unsigned char buf[4][128];
+    size_t ptr;
+    uint64_t T0, T1;
+} blake512_4way_context;
+
+/* Non-zero when the AVX2 kernel is used. */
+int blake512_4way_available(void);
+
+void blake512_4way_init(blake512_4way_context *ctx);
+void blake512_4way_update(blake512_4way_context *ctx, const void *const data[4], size_t len);
+void blake512_4way_close(blake512_4way_context *ctx, void *const dst[4]);
+
+/* One-shot hashes of four len byte inputs into four 64 byte digests. */
+void blake512_4way(const void *const data[4], size_t len, void *const dst[4]);
+
+/* The same for 80 byte block headers, with the padding block precomputed. */
+void blake512_4way_80(const void *const data[4], void *const dst[4]);
+
+/*
+ * For the chains that start with blake512 of the input (x11 and friends):
+ * hashes count inputs of len[i] bytes, or 80 each when len is NULL, and
+ * hands every 64 byte digest to chain for the remaining stages. Groups of
+ * four equal length inputs go through the 4-way kernel when it is
+ * available, the rest through sph_blake512.
+ */
+typedef void (*blake512_chain_fn)(uint32_t hash[16], char *output);
+
+void blake512_4way_chain(const char *const *input, char *const *output, const uint32_t *len,
+    uint32_t count, blake512_chain_fn chain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,205 @@
+#include "echo_aesni.h"
+#include "sph_echo.h"
+#include "../cpu.h"
+
+#ifdef CPU_X86
+
+#include <immintrin.h>
+
+#define AESNI CPU_TARGET("aes,sse2")
+
+#define LOAD(p)     _mm_loadu_si128((const __m128i*) (p))
+#define STORE(p, x) _mm_storeu_si128((__m128i*) (p), x)
+
+/* multiplication by 2 in GF(2^8) modulo x^8 + x^4 + x^3 + x + 1 */
+#define MUL2(x)     _mm_xor_si128(_mm_add_epi8(x, x), _mm_and_si128(_mm_cmpgt_epi8(zero, x), poly))
+
+/*
+ * Two AES rounds on word i, the first keyed with the 128-bit salt k, which
+ * counts up by one per word. The 64-bit add is enough while the low half
+ * does not wrap within the round; sub_words falls back to carrying by hand
+ * otherwise.
+ */
+#define AES_2ROUNDS(i)   do { \
+        W[i] = _mm_aesenc_si128(_mm_aesenc_si128(W[i], k), zero); \
+        k = _mm_add_epi64(k, one); \
+    } while (0)
+
+#define AES_2ROUNDS_CARRY(i)   do { \
+        W[i] = _mm_aesenc_si128(_mm_aesenc_si128(W[i], _mm_set_epi64x((int64_t) *hi, (int64_t) *lo)), zero); \
+        if (++*lo == 0) \
+            ++*hi; \
+    } while (0)
+
+AESNI static inline __attribute__((always_inline)) void
+sub_words(__m128i W[16], uint64_t *lo, uint64_t *hi)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    if (*lo <= UINT64_MAX - 16) {
+        const __m128i one = _mm_set_epi64x(0, 1);
+        __m128i k = _mm_set_epi64x((int64_t) *hi, (int64_t) *lo);
+
+        AES_2ROUNDS(0);
+        AES_2ROUNDS(1);
+        AES_2ROUNDS(2);
+        AES_2ROUNDS(3);
+        AES_2ROUNDS(4);
+        AES_2ROUNDS(5);
+        AES_2ROUNDS(6);
+        AES_2ROUNDS(7);
+        AES_2ROUNDS(8);
+        AES_2ROUNDS(9);
+        AES_2ROUNDS(10);
+        AES_2ROUNDS(11);
+        AES_2ROUNDS(12);
+        AES_2ROUNDS(13);
+        AES_2ROUNDS(14);
+        AES_2ROUNDS(15);
+        *lo += 16;
+    } else {
+        AES_2ROUNDS_CARRY(0);
+        AES_2ROUNDS_CARRY(1);
+        AES_2ROUNDS_CARRY(2);
+        AES_2ROUNDS_CARRY(3);
+        AES_2ROUNDS_CARRY(4);
+        AES_2ROUNDS_CARRY(5);
+        AES_2ROUNDS_CARRY(6);
+        AES_2ROUNDS_CARRY(7);
+        AES_2ROUNDS_CARRY(8);
+        AES_2ROUNDS_CARRY(9);
+        AES_2ROUNDS_CARRY(10);
+        AES_2ROUNDS_CARRY(11);
+        AES_2ROUNDS_CARRY(12);
+        AES_2ROUNDS_CARRY(13);
+        AES_2ROUNDS_CARRY(14);
+        AES_2ROUNDS_CARRY(15);
+    }
+}
+
+/*
+ * BIG.ShiftRows folded into BIG.MixColumns: column c of the result takes
+ * row r from column c + r of the input, and is then mixed bytewise like an
+ * AES column.
+ */
+#define MIX_COLUMN(c, ia, ib, ic, id)   do { \
+        __m128i a = in[ia], b = in[ib], c_ = in[ic], d = in[id]; \
+        __m128i ab = _mm_xor_si128(a, b); \
+        __m128i bc = _mm_xor_si128(b, c_); \
+        __m128i cd = _mm_xor_si128(c_, d); \
+        __m128i abx = MUL2(ab); \
+        __m128i bcx = MUL2(bc); \
+        __m128i cdx = MUL2(cd); \
+        out[4 * c] = _mm_xor_si128(_mm_xor_si128(abx, bc), d); \
+        out[4 * c + 1] = _mm_xor_si128(_mm_xor_si128(bcx, a), cd); \
+        out[4 * c + 2] = _mm_xor_si128(_mm_xor_si128(cdx, ab), d); \
+        out[4 * c + 3] = _mm_xor_si128(_mm_xor_si128(_mm_xor_si128(abx, bcx), \
+            _mm_xor_si128(cdx, ab)), c_); \
+    } while (0)
+
+AESNI static inline __attribute__((always_inline)) void
+shift_mix(const __m128i in[16], __m128i out[16])
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i poly = _mm_set1_epi8(0x1b);
+
+    MIX_COLUMN(0, 0, 5, 10, 15);
+    MIX_COLUMN(1, 4, 9, 14, 3);
+    MIX_COLUMN(2, 8, 13, 2, 7);
+    MIX_COLUMN(3, 12, 1, 6, 11);
+}
+
+/* the ten rounds of ECHO-384/512 from the salt (lo, hi), two per pass */
+AESNI static inline __attribute__((always_inline)) void
+big_rounds(__m128i W[16], uint64_t lo, uint64_t hi)
+{
+    __m128i T[16];
+    int r;
+
+    for (r = 0; r < 10; r += 2) {
+        sub_words(W, &lo, &hi);
+        shift_mix(W, T);
+        sub_words(T, &lo, &hi);
+        shift_mix(T, W);
+    }
+}
+
+int echo_aesni_available(void)
+{
+    return (cpu_features() & CPU_FEATURE_AES) != 0;
+}
+
+AESNI void echo_big_aesni_compress(uint64_t V[8][2], const unsigned char *buf,
+    uint32_t C0, uint32_t C1, uint32_t C2, uint32_t C3)
+{
+    __m128i W[16];
+    int k;
+
+    for (k = 0; k < 8; k++) {
+        W[k] = LOAD(V[k]);
+        W[k + 8] = LOAD(buf + 16 * k);
+    }
+
+    big_rounds(W, (uint64_t) C1 << 32 | C0, (uint64_t) C3 << 32 | C2);
+
+    for (k = 0; k < 8; k++)
+        STORE(V[k], _mm_xor_si128(_mm_xor_si128(LOAD(V[k]), LOAD(buf + 16 * k)),
+            _mm_xor_si128(W[k], W[k + 8])));
+}
+
+/*
+ * The one block of a 64 byte message: the chaining value starts as 512 in
+ * each word, the block is the message, the 0x80 padding byte, the output
+ * length 512 at byte 110 and the bit count 512 as the last word, which is
+ * also the salt.
+ */
+AESNI static void echo512_aesni_64(const void *data, void *dst)
+{
+    const __m128i iv = _mm_set_epi64x(0, 512);
+    const unsigned char *in = (const unsigned char *) data;
+    unsigned char *out = (unsigned char *) dst;
+    __m128i W[16];
+    int k;
+
+    for (k = 0; k < 8; k++)
+        W[k] = iv;
+    W[8] = LOAD(in);
+    W[9] = LOAD(in + 16);
+    W[10] = LOAD(in + 32);
+    W[11] = LOAD(in + 48);
+    W[12] = _mm_set_epi64x(0, 0x80);
+    W[13] = _mm_setzero_si128();
+    W[14] = _mm_set_epi16(0x0200, 0, 0, 0, 0, 0, 0, 0);
+    W[15] = iv;
+
+    big_rounds(W, 512, 0);
+
+    /* only the first four words of the chaining value are output */
+    for (k = 0; k < 4; k++)
+        STORE(out + 16 * k, _mm_xor_si128(_mm_xor_si128(iv, LOAD(in + 16 * k)),
+            _mm_xor_si128(W[k], W[k + 8])));
+}
+
+#else
+
+int echo_aesni_available(void)
+{
+    return 0;
+}
+
+#endif
+
+void echo512_64(const void *data, void *dst)
+{
+    sph_echo512_context ctx;
+
+#ifdef CPU_X86
+    if (echo_aesni_available()) {
+        echo512_aesni_64(data, dst);
+        return;
+    }
+#endif
+    sph_echo512_init(&ctx);
+    sph_echo512(&ctx, data, 64);
+    sph_echo512_close(&ctx, dst);
+}
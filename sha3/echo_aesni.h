@@ -0,0 +1,35 @@
+#ifndef ECHO_AESNI_H
+#define ECHO_AESNI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * ECHO-384/512 on AES-NI, for sph_echo.c. Each of the 16 128-bit words of
+ * the state is an AES state, so BIG.SubWords is two AESENC per word and
+ * BIG.MixColumns works on whole words. V is the chaining value in
+ * sph_echo's little-endian layout, buf one message block and C0..C3 the
+ * bit counter the block's salt starts from.
+ */
+
+/* Non-zero when the CPU has AES-NI. */
+int echo_aesni_available(void);
+
+void echo_big_aesni_compress(uint64_t V[8][2], const unsigned char *buf,
+    uint32_t C0, uint32_t C1, uint32_t C2, uint32_t C3);
+
+/*
+ * ECHO-512 of a 64 byte input, the last stage of x11 and the chains built
+ * on it. The message and its padding fit one block, which is compressed
+ * straight from registers; without AES-NI this is sph_echo512.
+ */
+void echo512_64(const void *data, void *dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,310 @@
+#include "groestl_aesni.h"
+#include "../cpu.h"
+
+#ifdef CPU_X86
+
+#include <immintrin.h>
+
+#define AESNI CPU_TARGET("aes,ssse3")
+
+/*
+ * Per row: the ShiftBytes rotation, composed with the inverse of the
+ * ShiftRows that AESENCLAST applies after SubBytes. The 512-bit rows hold
+ * P's row in the low 8 bytes and Q's in the high 8 bytes.
+ */
+static const unsigned char shift_small[8][16] = {
+    {  0, 14, 11,  7,  4,  1, 15, 12,  9,  5,  2,  8, 13, 10,  6,  3 },
+    {  1,  8, 13,  0,  5,  2,  9, 14, 11,  6,  3, 10, 15, 12,  7,  4 },
+    {  2, 10, 15,  1,  6,  3, 11,  8, 13,  7,  4, 12,  9, 14,  0,  5 },
+    {  3, 12,  9,  2,  7,  4, 13, 10, 15,  0,  5, 14, 11,  8,  1,  6 },
+    {  4, 13, 10,  3,  0,  5, 14, 11,  8,  1,  6, 15, 12,  9,  2,  7 },
+    {  5, 15, 12,  4,  1,  6,  8, 13, 10,  2,  7,  9, 14, 11,  3,  0 },
+    {  6,  9, 14,  5,  2,  7, 10, 15, 12,  3,  0, 11,  8, 13,  4,  1 },
+    {  7, 11,  8,  6,  3,  0, 12,  9, 14,  4,  1, 13, 10, 15,  5,  2 }
+};
+
+/* the same for the 1024-bit rows, rotated by P's 0, 1, 2, 3, 4, 5, 6 and 11 */
+static const unsigned char shift_big[8][16] = {
+    {  0, 13, 10,  7,  4,  1, 14, 11,  8,  5,  2, 15, 12,  9,  6,  3 },
+    {  1, 14, 11,  8,  5,  2, 15, 12,  9,  6,  3,  0, 13, 10,  7,  4 },
+    {  2, 15, 12,  9,  6,  3,  0, 13, 10,  7,  4,  1, 14, 11,  8,  5 },
+    {  3,  0, 13, 10,  7,  4,  1, 14, 11,  8,  5,  2, 15, 12,  9,  6 },
+    {  4,  1, 14, 11,  8,  5,  2, 15, 12,  9,  6,  3,  0, 13, 10,  7 },
+    {  5,  2, 15, 12,  9,  6,  3,  0, 13, 10,  7,  4,  1, 14, 11,  8 },
+    {  6,  3,  0, 13, 10,  7,  4,  1, 14, 11,  8,  5,  2, 15, 12,  9 },
+    { 11,  8,  5,  2, 15, 12,  9,  6,  3,  0, 13, 10,  7,  4,  1, 14 }
+};
+
+#define LOAD(p)     _mm_loadu_si128((const __m128i*) (p))
+#define STORE(p, x) _mm_storeu_si128((__m128i*) (p), x)
+
+/* multiplication by 2 in GF(2^8) modulo x^8 + x^4 + x^3 + x + 1 */
+#define MUL2(x)     _mm_xor_si128(_mm_add_epi8(x, x), _mm_and_si128(_mm_cmpgt_epi8(zero, x), poly))
+
+/*
+ * Transposes the 8x8 byte matrix in x[0..3], turning 8 columns of the sph
+ * layout into 8 rows (two per register) and back.
+ */
+AESNI static inline __attribute__((always_inline)) void transpose(__m128i x[4])
+{
+    const __m128i pairs = _mm_setr_epi8(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+    __m128i s0 = _mm_shuffle_epi8(x[0], pairs);
+    __m128i s1 = _mm_shuffle_epi8(x[1], pairs);
+    __m128i s2 = _mm_shuffle_epi8(x[2], pairs);
+    __m128i s3 = _mm_shuffle_epi8(x[3], pairs);
+    __m128i a0 = _mm_unpacklo_epi16(s0, s1);
+    __m128i a1 = _mm_unpackhi_epi16(s0, s1);
+    __m128i a2 = _mm_unpacklo_epi16(s2, s3);
+    __m128i a3 = _mm_unpackhi_epi16(s2, s3);
+
+    x[0] = _mm_unpacklo_epi32(a0, a2);
+    x[1] = _mm_unpackhi_epi32(a0, a2);
+    x[2] = _mm_unpacklo_epi32(a1, a3);
+    x[3] = _mm_unpackhi_epi32(a1, a3);
+}
+
+/*
+ * MixBytes, each row i becoming
+ * 2a[i] ^ 2a[i+1] ^ 3a[i+2] ^ 4a[i+3] ^ 5a[i+4] ^ 3a[i+5] ^ 5a[i+6] ^ 7a[i+7],
+ * computed as x1 ^ 2(x2 ^ 2 x4) from the sums t[i] = a[i] ^ a[i+1].
+ */
+#define MIX_ROW(b, a2, a5, a7, t0, t3, t4, t6)   do { \
+        __m128i x4 = _mm_xor_si128(t3, t6); \
+        __m128i x2 = _mm_xor_si128(_mm_xor_si128(t0, a2), _mm_xor_si128(a5, a7)); \
+        __m128i x1 = _mm_xor_si128(a2, _mm_xor_si128(t4, t6)); \
+        x2 = _mm_xor_si128(x2, MUL2(x4)); \
+        b = _mm_xor_si128(x1, MUL2(x2)); \
+    } while (0)
+
+AESNI static inline __attribute__((always_inline)) void mix_bytes(__m128i a[8])
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i poly = _mm_set1_epi8(0x1b);
+    __m128i t0 = _mm_xor_si128(a[0], a[1]);
+    __m128i t1 = _mm_xor_si128(a[1], a[2]);
+    __m128i t2 = _mm_xor_si128(a[2], a[3]);
+    __m128i t3 = _mm_xor_si128(a[3], a[4]);
+    __m128i t4 = _mm_xor_si128(a[4], a[5]);
+    __m128i t5 = _mm_xor_si128(a[5], a[6]);
+    __m128i t6 = _mm_xor_si128(a[6], a[7]);
+    __m128i t7 = _mm_xor_si128(a[7], a[0]);
+    __m128i b0, b1, b2, b3, b4, b5, b6, b7;
+
+    MIX_ROW(b0, a[2], a[5], a[7], t0, t3, t4, t6);
+    MIX_ROW(b1, a[3], a[6], a[0], t1, t4, t5, t7);
+    MIX_ROW(b2, a[4], a[7], a[1], t2, t5, t6, t0);
+    MIX_ROW(b3, a[5], a[0], a[2], t3, t6, t7, t1);
+    MIX_ROW(b4, a[6], a[1], a[3], t4, t7, t0, t2);
+    MIX_ROW(b5, a[7], a[2], a[4], t5, t0, t1, t3);
+    MIX_ROW(b6, a[0], a[3], a[5], t6, t1, t2, t4);
+    MIX_ROW(b7, a[1], a[4], a[6], t7, t2, t3, t5);
+
+    a[0] = b0;
+    a[1] = b1;
+    a[2] = b2;
+    a[3] = b3;
+    a[4] = b4;
+    a[5] = b5;
+    a[6] = b6;
+    a[7] = b7;
+}
+
+/* SubBytes and ShiftBytes of a row, with the shift_* row for it */
+#define SUB_SHIFT(x, shift)     _mm_aesenclast_si128(_mm_shuffle_epi8(x, LOAD(shift)), _mm_setzero_si128())
+
+/* P on the low halves of the rows and Q on the high halves at once */
+AESNI static inline __attribute__((always_inline)) void perm_small(__m128i a[8])
+{
+    const __m128i p0 = _mm_setr_epi8(0x00, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i q7 = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0,
+        0xff, 0xef, 0xdf, 0xcf, 0xbf, 0xaf, 0x9f, 0x8f);
+    const __m128i q_half = _mm_set_epi64x(-1, 0);
+    int r;
+
+    for (r = 0; r < 10; r++) {
+        __m128i rc = _mm_set1_epi8(r);
+
+        a[0] = SUB_SHIFT(_mm_xor_si128(a[0], _mm_xor_si128(p0, _mm_andnot_si128(q_half, rc))), shift_small[0]);
+        a[1] = SUB_SHIFT(_mm_xor_si128(a[1], q_half), shift_small[1]);
+        a[2] = SUB_SHIFT(_mm_xor_si128(a[2], q_half), shift_small[2]);
+        a[3] = SUB_SHIFT(_mm_xor_si128(a[3], q_half), shift_small[3]);
+        a[4] = SUB_SHIFT(_mm_xor_si128(a[4], q_half), shift_small[4]);
+        a[5] = SUB_SHIFT(_mm_xor_si128(a[5], q_half), shift_small[5]);
+        a[6] = SUB_SHIFT(_mm_xor_si128(a[6], q_half), shift_small[6]);
+        a[7] = SUB_SHIFT(_mm_xor_si128(a[7], _mm_xor_si128(q7, _mm_and_si128(q_half, rc))), shift_small[7]);
+        mix_bytes(a);
+    }
+}
+
+AESNI static inline __attribute__((always_inline)) void round_big_p(__m128i a[8], int r)
+{
+    const __m128i p0 = _mm_setr_epi8(0x00, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70,
+        0x80, 0x90, 0xa0, 0xb0, 0xc0, 0xd0, 0xe0, 0xf0);
+
+    a[0] = SUB_SHIFT(_mm_xor_si128(a[0], _mm_xor_si128(p0, _mm_set1_epi8(r))), shift_big[0]);
+    a[1] = SUB_SHIFT(a[1], shift_big[1]);
+    a[2] = SUB_SHIFT(a[2], shift_big[2]);
+    a[3] = SUB_SHIFT(a[3], shift_big[3]);
+    a[4] = SUB_SHIFT(a[4], shift_big[4]);
+    a[5] = SUB_SHIFT(a[5], shift_big[5]);
+    a[6] = SUB_SHIFT(a[6], shift_big[6]);
+    a[7] = SUB_SHIFT(a[7], shift_big[7]);
+    mix_bytes(a);
+}
+
+/* Q's rotations 1, 3, 5, 11, 0, 2, 4 and 6 are rows of shift_big too */
+AESNI static inline __attribute__((always_inline)) void round_big_q(__m128i a[8], int r)
+{
+    const __m128i q7 = _mm_setr_epi8(0xff, 0xef, 0xdf, 0xcf, 0xbf, 0xaf, 0x9f, 0x8f,
+        0x7f, 0x6f, 0x5f, 0x4f, 0x3f, 0x2f, 0x1f, 0x0f);
+    const __m128i ones = _mm_set1_epi8(-1);
+
+    a[0] = SUB_SHIFT(_mm_xor_si128(a[0], ones), shift_big[1]);
+    a[1] = SUB_SHIFT(_mm_xor_si128(a[1], ones), shift_big[3]);
+    a[2] = SUB_SHIFT(_mm_xor_si128(a[2], ones), shift_big[5]);
+    a[3] = SUB_SHIFT(_mm_xor_si128(a[3], ones), shift_big[7]);
+    a[4] = SUB_SHIFT(_mm_xor_si128(a[4], ones), shift_big[0]);
+    a[5] = SUB_SHIFT(_mm_xor_si128(a[5], ones), shift_big[2]);
+    a[6] = SUB_SHIFT(_mm_xor_si128(a[6], ones), shift_big[4]);
+    a[7] = SUB_SHIFT(_mm_xor_si128(a[7], _mm_xor_si128(q7, _mm_set1_epi8(r))), shift_big[6]);
+    mix_bytes(a);
+}
+
+/* 16 columns of the sph layout to 8 rows of 16 bytes */
+AESNI static inline __attribute__((always_inline)) void rows_big(const __m128i x[8], __m128i a[8])
+{
+    __m128i lo[4] = { x[0], x[1], x[2], x[3] };
+    __m128i hi[4] = { x[4], x[5], x[6], x[7] };
+    int k;
+
+    transpose(lo);
+    transpose(hi);
+    for (k = 0; k < 4; k++) {
+        a[2 * k] = _mm_unpacklo_epi64(lo[k], hi[k]);
+        a[2 * k + 1] = _mm_unpackhi_epi64(lo[k], hi[k]);
+    }
+}
+
+AESNI static inline __attribute__((always_inline)) void columns_big(const __m128i a[8], __m128i x[8])
+{
+    __m128i lo[4], hi[4];
+    int k;
+
+    for (k = 0; k < 4; k++) {
+        lo[k] = _mm_unpacklo_epi64(a[2 * k], a[2 * k + 1]);
+        hi[k] = _mm_unpackhi_epi64(a[2 * k], a[2 * k + 1]);
+    }
+    transpose(lo);
+    transpose(hi);
+    for (k = 0; k < 4; k++) {
+        x[k] = lo[k];
+        x[k + 4] = hi[k];
+    }
+}
+
+AESNI void groestl_small_aesni_compress(uint64_t H[8], const unsigned char *buf)
+{
+    __m128i h[4], p[4], m[4], a[8];
+    int k;
+
+    for (k = 0; k < 4; k++) {
+        h[k] = LOAD(H + 2 * k);
+        m[k] = LOAD(buf + 16 * k);
+        p[k] = _mm_xor_si128(h[k], m[k]);
+    }
+    transpose(p);
+    transpose(m);
+    for (k = 0; k < 4; k++) {
+        a[2 * k] = _mm_unpacklo_epi64(p[k], m[k]);
+        a[2 * k + 1] = _mm_unpackhi_epi64(p[k], m[k]);
+    }
+
+    perm_small(a);
+
+    for (k = 0; k < 4; k++) {
+        __m128i even = _mm_xor_si128(a[2 * k], _mm_unpackhi_epi64(a[2 * k], a[2 * k]));
+        __m128i odd = _mm_xor_si128(a[2 * k + 1], _mm_unpackhi_epi64(a[2 * k + 1], a[2 * k + 1]));
+
+        p[k] = _mm_unpacklo_epi64(even, odd);
+    }
+    transpose(p);
+    for (k = 0; k < 4; k++)
+        STORE(H + 2 * k, _mm_xor_si128(h[k], p[k]));
+}
+
+AESNI void groestl_small_aesni_final(uint64_t H[8])
+{
+    __m128i h[4], p[4], a[8];
+    int k;
+
+    for (k = 0; k < 4; k++)
+        h[k] = p[k] = LOAD(H + 2 * k);
+    transpose(p);
+    /* Q runs on a copy in the high halves and is thrown away */
+    for (k = 0; k < 4; k++) {
+        a[2 * k] = _mm_unpacklo_epi64(p[k], p[k]);
+        a[2 * k + 1] = _mm_unpackhi_epi64(p[k], p[k]);
+    }
+
+    perm_small(a);
+
+    for (k = 0; k < 4; k++)
+        p[k] = _mm_unpacklo_epi64(a[2 * k], a[2 * k + 1]);
+    transpose(p);
+    for (k = 0; k < 4; k++)
+        STORE(H + 2 * k, _mm_xor_si128(h[k], p[k]));
+}
+
+AESNI void groestl_big_aesni_compress(uint64_t H[16], const unsigned char *buf)
+{
+    __m128i h[8], x[8], p[8], q[8];
+    int k, r;
+
+    for (k = 0; k < 8; k++) {
+        h[k] = LOAD(H + 2 * k);
+        x[k] = LOAD(buf + 16 * k);
+    }
+    rows_big(x, q);
+    for (k = 0; k < 8; k++)
+        x[k] = _mm_xor_si128(x[k], h[k]);
+    rows_big(x, p);
+
+    for (r = 0; r < 14; r++) {
+        round_big_p(p, r);
+        round_big_q(q, r);
+    }
+
+    for (k = 0; k < 8; k++)
+        p[k] = _mm_xor_si128(p[k], q[k]);
+    columns_big(p, x);
+    for (k = 0; k < 8; k++)
+        STORE(H + 2 * k, _mm_xor_si128(h[k], x[k]));
+}
+
+AESNI void groestl_big_aesni_final(uint64_t H[16])
+{
+    __m128i h[8], p[8];
+    int k, r;
+
+    for (k = 0; k < 8; k++)
+        h[k] = LOAD(H + 2 * k);
+    rows_big(h, p);
+
+    for (r = 0; r < 14; r++)
+        round_big_p(p, r);
+
+    columns_big(p, p);
+    for (k = 0; k < 8; k++)
+        STORE(H + 2 * k, _mm_xor_si128(h[k], p[k]));
+}
+
+#endif
+
+int groestl_aesni_available(void)
+{
+#ifdef CPU_X86
+    return (cpu_features() & (CPU_FEATURE_AES | CPU_FEATURE_SSSE3)) == (CPU_FEATURE_AES | CPU_FEATURE_SSSE3);
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,33 @@
+#ifndef GROESTL_AESNI_H
+#define GROESTL_AESNI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Grøstl's P and Q permutations on AES-NI and SSSE3, for sph_groestl.c. The
+ * state is 8 rows kept one per register, so SubBytes is AESENCLAST with the
+ * ShiftRows it adds folded into the PSHUFB that does ShiftBytes, and
+ * MixBytes works on all columns at once. H is the chaining value in
+ * sph_groestl's little-endian column layout, buf one message block.
+ */
+
+/* Non-zero when the CPU has AES-NI and SSSE3. */
+int groestl_aesni_available(void);
+
+/* Grøstl-224/256: H ^= P(H ^ m) ^ Q(m), and the output transform H ^= P(H). */
+void groestl_small_aesni_compress(uint64_t H[8], const unsigned char *buf);
+void groestl_small_aesni_final(uint64_t H[8]);
+
+/* Grøstl-384/512, the same on the 1024-bit state. */
+void groestl_big_aesni_compress(uint64_t H[16], const unsigned char *buf);
+void groestl_big_aesni_final(uint64_t H[16]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
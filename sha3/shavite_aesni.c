@@ -0,0 +1,168 @@
+#include "shavite_aesni.h"
+#include "../cpu.h"
+
+#ifdef CPU_X86
+
+#include <immintrin.h>
+
+#define AESNI CPU_TARGET("aes,ssse3")
+
+#define LOAD(p)     _mm_loadu_si128((const __m128i*) (p))
+#define STORE(p, x) _mm_storeu_si128((__m128i*) (p), x)
+
+/* an unkeyed AES round, as sph_shavite's AES_ROUND_NOKEY */
+#define AES0(x)     _mm_aesenc_si128(x, zero)
+
+/*
+ * The two kinds of round key groups: the nonlinear one rotates the group 4
+ * (C256) or 8 (C512) back by one word, runs it through AES and adds the
+ * previous group; the linear one adds the words 3 or 7 back to it.
+ */
+#define KEY_NL(k, back, prev)   (k = _mm_xor_si128(AES0(_mm_shuffle_epi32(back, 0x39)), prev))
+#define KEY_LIN512(k, back, prev2, prev)   (k = _mm_xor_si128(back, _mm_alignr_epi8(prev, prev2, 4)))
+
+/* C256's last word also takes the first of the new group */
+#define KEY_LIN256(k, back, prev)   do { \
+        __m128i t = _mm_xor_si128(back, _mm_srli_si128(prev, 4)); \
+        k = _mm_xor_si128(t, _mm_slli_si128(t, 12)); \
+    } while (0)
+
+AESNI void shavite_small_aesni_compress(uint32_t h[8], const unsigned char *msg,
+    uint32_t count0, uint32_t count1)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i rk[36], *k;
+    __m128i p0, p1, x;
+    int r;
+
+    rk[0] = LOAD(msg);
+    rk[1] = LOAD(msg + 16);
+    rk[2] = LOAD(msg + 32);
+    rk[3] = LOAD(msg + 48);
+    /* four nonlinear groups then four linear ones, the counter in four places */
+    for (r = 0, k = rk + 4; r < 4; r++, k += 8) {
+        KEY_NL(k[0], k[-4], k[-1]);
+        if (r == 0)
+            k[0] = _mm_xor_si128(k[0], _mm_set_epi32(0, 0, (int) ~count1, (int) count0));
+        KEY_NL(k[1], k[-3], k[0]);
+        if (r == 2)
+            k[1] = _mm_xor_si128(k[1], _mm_set_epi32((int) ~count0, (int) count1, 0, 0));
+        KEY_NL(k[2], k[-2], k[1]);
+        if (r == 1)
+            k[2] = _mm_xor_si128(k[2], _mm_set_epi32(0, (int) ~count0, (int) count1, 0));
+        KEY_NL(k[3], k[-1], k[2]);
+        if (r == 3)
+            k[3] = _mm_xor_si128(k[3], _mm_set_epi32((int) ~count1, 0, 0, (int) count0));
+        KEY_LIN256(k[4], k[0], k[3]);
+        KEY_LIN256(k[5], k[1], k[4]);
+        KEY_LIN256(k[6], k[2], k[5]);
+        KEY_LIN256(k[7], k[3], k[6]);
+    }
+
+    p0 = LOAD(h);
+    p1 = LOAD(h + 4);
+    for (r = 0; r < 6; r++) {
+        k = rk + 6 * r;
+        x = _mm_aesenc_si128(_mm_aesenc_si128(_mm_xor_si128(p1, k[0]), k[1]), k[2]);
+        p0 = _mm_xor_si128(p0, AES0(x));
+        x = _mm_aesenc_si128(_mm_aesenc_si128(_mm_xor_si128(p0, k[3]), k[4]), k[5]);
+        p1 = _mm_xor_si128(p1, AES0(x));
+    }
+    STORE(h, _mm_xor_si128(LOAD(h), p0));
+    STORE(h + 4, _mm_xor_si128(LOAD(h + 4), p1));
+}
+
+/* half a C512 round: four AES rounds on r keyed by k0..k3, added into l */
+#define C512_ELT(l, r, k0, k1, k2, k3)   do { \
+        __m128i x = _mm_xor_si128(r, k0); \
+        x = _mm_aesenc_si128(x, k1); \
+        x = _mm_aesenc_si128(x, k2); \
+        x = _mm_aesenc_si128(x, k3); \
+        l = _mm_xor_si128(l, AES0(x)); \
+    } while (0)
+
+#define C512_ROUND   do { \
+        __m128i t; \
+        C512_ELT(p0, p1, k0, k1, k2, k3); \
+        C512_ELT(p2, p3, k4, k5, k6, k7); \
+        t = p3; \
+        p3 = p2; \
+        p2 = p1; \
+        p1 = p0; \
+        p0 = t; \
+    } while (0)
+
+/*
+ * Each round takes the next eight key groups, so the schedule is kept as a
+ * window of eight registers and advanced in place between rounds, nonlinear
+ * before odd rounds and linear before even ones.
+ */
+AESNI void shavite_big_aesni_compress(uint32_t h[16], const unsigned char *msg,
+    uint32_t count0, uint32_t count1, uint32_t count2, uint32_t count3)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i k0, k1, k2, k3, k4, k5, k6, k7;
+    __m128i p0, p1, p2, p3;
+    int r;
+
+    k0 = LOAD(msg);
+    k1 = LOAD(msg + 16);
+    k2 = LOAD(msg + 32);
+    k3 = LOAD(msg + 48);
+    k4 = LOAD(msg + 64);
+    k5 = LOAD(msg + 80);
+    k6 = LOAD(msg + 96);
+    k7 = LOAD(msg + 112);
+    p0 = LOAD(h);
+    p1 = LOAD(h + 4);
+    p2 = LOAD(h + 8);
+    p3 = LOAD(h + 12);
+
+    C512_ROUND;
+    for (r = 1; r < 14; r++) {
+        if (r & 1) {
+            KEY_NL(k0, k0, k7);
+            if (r == 1)
+                k0 = _mm_xor_si128(k0, _mm_set_epi32((int) ~count3, (int) count2, (int) count1, (int) count0));
+            KEY_NL(k1, k1, k0);
+            if (r == 5)
+                k1 = _mm_xor_si128(k1, _mm_set_epi32((int) ~count0, (int) count1, (int) count2, (int) count3));
+            KEY_NL(k2, k2, k1);
+            KEY_NL(k3, k3, k2);
+            KEY_NL(k4, k4, k3);
+            KEY_NL(k5, k5, k4);
+            KEY_NL(k6, k6, k5);
+            if (r == 13)
+                k6 = _mm_xor_si128(k6, _mm_set_epi32((int) ~count2, (int) count3, (int) count0, (int) count1));
+            KEY_NL(k7, k7, k6);
+            if (r == 9)
+                k7 = _mm_xor_si128(k7, _mm_set_epi32((int) ~count1, (int) count0, (int) count3, (int) count2));
+        } else {
+            KEY_LIN512(k0, k0, k6, k7);
+            KEY_LIN512(k1, k1, k7, k0);
+            KEY_LIN512(k2, k2, k0, k1);
+            KEY_LIN512(k3, k3, k1, k2);
+            KEY_LIN512(k4, k4, k2, k3);
+            KEY_LIN512(k5, k5, k3, k4);
+            KEY_LIN512(k6, k6, k4, k5);
+            KEY_LIN512(k7, k7, k5, k6);
+        }
+        C512_ROUND;
+    }
+
+    STORE(h, _mm_xor_si128(LOAD(h), p0));
+    STORE(h + 4, _mm_xor_si128(LOAD(h + 4), p1));
+    STORE(h + 8, _mm_xor_si128(LOAD(h + 8), p2));
+    STORE(h + 12, _mm_xor_si128(LOAD(h + 12), p3));
+}
+
+#endif
+
+int shavite_aesni_available(void)
+{
+#ifdef CPU_X86
+    return (cpu_features() & (CPU_FEATURE_AES | CPU_FEATURE_SSSE3)) == (CPU_FEATURE_AES | CPU_FEATURE_SSSE3);
+#else
+    return 0;
+#endif
+}
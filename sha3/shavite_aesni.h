@@ -0,0 +1,33 @@
+#ifndef SHAVITE_AESNI_H
+#define SHAVITE_AESNI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * SHAvite-3's compression functions on AES-NI and SSSE3, for sph_shavite.c.
+ * Every AES round of the Feistel rounds and of the message expansion is
+ * one AESENC, and each 128-bit group of round keys is one register. h is
+ * the chaining value, msg one message block and count* the bit counter
+ * sph_shavite mixes into the key schedule.
+ */
+
+/* Non-zero when the CPU has AES-NI and SSSE3. */
+int shavite_aesni_available(void);
+
+/* SHAvite-3-224/256, C256 on a 64 byte block. */
+void shavite_small_aesni_compress(uint32_t h[8], const unsigned char *msg,
+    uint32_t count0, uint32_t count1);
+
+/* SHAvite-3-384/512, C512 on a 128 byte block. */
+void shavite_big_aesni_compress(uint32_t h[16], const unsigned char *msg,
+    uint32_t count0, uint32_t count1, uint32_t count2, uint32_t count3);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,179 @@
+/*
+ * The number-theoretic transform of SIMD-384/512 on vectors of 16-bit lanes,
+ * included by simd_vec.c once per instruction set. The includer defines V
+ * (the vector type), the V_* operations on it, TARGET and FN(name).
+ *
+ * The 256-point NTT with root 41 of the 128 message bytes x[j], j = c + 16d,
+ * is done as two 16-point NTTs with root 41^16 = 2, so that every product
+ * inside them is a shift:
+ *
+ *   Y[a][c] = sum_d x[c + 16d] 2^(a d)          (ntt_rows, lanes are c)
+ *   Z[a][c] = Y[a][c] 41^(a c)                   (twiddle)
+ *   q[a + 16b] = sum_c Z[a][c] 2^(b c)           (ntt_cols, lanes are a)
+ *
+ * with a transposition (transpose8) in between. All values stay within 16 bits by
+ * reducing modulo 257 before each shift or product, and the output is in
+ * -128..128 like sph_simd's.
+ */
+
+/* x mod 257 in -127..383, for any 16-bit x */
+#define RED(x)      V_SUB(V_AND(x, m255), V_SRAI(x, 8))
+
+/* x mod 257 in -128..128 */
+#define CANON(x)    V_CANON(RED(x))
+#define V_CANON(x)  V_SUB(x, V_AND(V_CMPGT(x, c128), c257))
+
+#define NTT_CONSTANTS \
+    const V m255 = V_SET1(255); \
+    const V c128 = V_SET1(128); \
+    const V c257 = V_SET1(257)
+
+/* sph_simd's FFT8: the 8-point NTT with root 4 of x0..x3 and four zeros */
+#define FFT8(x0, x1, x2, x3, d)   do { \
+        V a0 = V_ADD(x0, x2); \
+        V a1 = V_ADD(x0, V_SLLI(x2, 4)); \
+        V a2 = V_SUB(x0, x2); \
+        V a3 = V_SUB(x0, V_SLLI(x2, 4)); \
+        V b0 = V_ADD(x1, x3); \
+        V b1 = V_ADD(V_SLLI(x1, 2), V_SLLI(x3, 6)); \
+        V b2 = V_SLLI(V_SUB(x1, x3), 4); \
+        V b3 = V_ADD(V_SLLI(x1, 6), V_SLLI(x3, 2)); \
+        d[0] = V_ADD(a0, b0); \
+        d[1] = V_ADD(a1, b1); \
+        d[2] = V_ADD(a2, b2); \
+        d[3] = V_ADD(a3, b3); \
+        d[4] = V_SUB(a0, b0); \
+        d[5] = V_SUB(a1, b1); \
+        d[6] = V_SUB(a2, b2); \
+        d[7] = V_SUB(a3, b3); \
+    } while (0)
+
+/* the butterfly of outputs k and k + n/2, the odd half times 2^shift */
+#define BUTTERFLY(e, o, shift, lo, hi)   do { \
+        V t_ = V_SLLI(CANON(o), shift); \
+        V u_ = RED(e); \
+        lo = V_ADD(u_, t_); \
+        hi = V_SUB(u_, t_); \
+    } while (0)
+
+/*
+ * Rows a = 0..15 for the lanes of x[d] = msg[c + 16d], each row multiplied
+ * by its twiddles from tw (a row of 16 per a) and reduced to -127..383.
+ */
+TARGET static inline __attribute__((always_inline)) void
+FN(ntt_rows)(const V x[8], V z[16], const int16_t *tw)
+{
+    NTT_CONSTANTS;
+    V d1[8], d2[8], y;
+    int k;
+
+    FFT8(x[0], x[2], x[4], x[6], d1);
+    FFT8(x[1], x[3], x[5], x[7], d2);
+
+    /* inputs are bytes, so row 0 and 8 need no reduction before adding */
+    z[0] = RED(V_ADD(d1[0], d2[0]));
+    y = V_SUB(d1[0], d2[0]);
+    z[8] = RED(V_MUL(CANON(y), V_LOAD(tw + 16 * 8)));
+    for (k = 1; k < 8; k++) {
+        V lo, hi;
+
+        BUTTERFLY(d1[k], d2[k], k, lo, hi);
+        z[k] = RED(V_MUL(CANON(lo), V_LOAD(tw + 16 * k)));
+        z[k + 8] = RED(V_MUL(CANON(hi), V_LOAD(tw + 16 * (k + 8))));
+    }
+}
+
+/* transposes each 128-bit lane of r as an 8x8 matrix of 16-bit elements */
+TARGET static inline __attribute__((always_inline)) void
+FN(transpose8)(const V r[8], V out[8])
+{
+    V t0 = V_UNPACKLO16(r[0], r[1]);
+    V t1 = V_UNPACKHI16(r[0], r[1]);
+    V t2 = V_UNPACKLO16(r[2], r[3]);
+    V t3 = V_UNPACKHI16(r[2], r[3]);
+    V t4 = V_UNPACKLO16(r[4], r[5]);
+    V t5 = V_UNPACKHI16(r[4], r[5]);
+    V t6 = V_UNPACKLO16(r[6], r[7]);
+    V t7 = V_UNPACKHI16(r[6], r[7]);
+    V s0 = V_UNPACKLO32(t0, t2);
+    V s1 = V_UNPACKHI32(t0, t2);
+    V s2 = V_UNPACKLO32(t1, t3);
+    V s3 = V_UNPACKHI32(t1, t3);
+    V s4 = V_UNPACKLO32(t4, t6);
+    V s5 = V_UNPACKHI32(t4, t6);
+    V s6 = V_UNPACKLO32(t5, t7);
+    V s7 = V_UNPACKHI32(t5, t7);
+
+    out[0] = V_UNPACKLO64(s0, s4);
+    out[1] = V_UNPACKHI64(s0, s4);
+    out[2] = V_UNPACKLO64(s1, s5);
+    out[3] = V_UNPACKHI64(s1, s5);
+    out[4] = V_UNPACKLO64(s2, s6);
+    out[5] = V_UNPACKHI64(s2, s6);
+    out[6] = V_UNPACKLO64(s3, s7);
+    out[7] = V_UNPACKHI64(s3, s7);
+}
+
+/* the 4-point NTT with root 16 */
+#define NTT4(z0, z1, z2, z3, out)   do { \
+        V e0 = V_ADD(z0, z2); \
+        V e1 = V_SUB(z0, z2); \
+        V o0 = V_ADD(z1, z3); \
+        V o1 = V_SLLI(V_SUB(z1, z3), 4); \
+        out[0] = V_ADD(e0, o0); \
+        out[1] = V_ADD(e1, o1); \
+        out[2] = V_SUB(e0, o0); \
+        out[3] = V_SUB(e1, o1); \
+    } while (0)
+
+/* the 8-point NTT with root 4 from the NTT4s of its even and odd inputs */
+#define NTT8(e, o, out)   do { \
+        V t_; \
+        out[0] = V_ADD(e[0], o[0]); \
+        out[4] = V_SUB(e[0], o[0]); \
+        t_ = V_SLLI(CANON(o[1]), 2); \
+        out[1] = V_ADD(e[1], t_); \
+        out[5] = V_SUB(e[1], t_); \
+        t_ = V_SLLI(CANON(o[2]), 4); \
+        out[2] = V_ADD(e[2], t_); \
+        out[6] = V_SUB(e[2], t_); \
+        t_ = V_SLLI(CANON(o[3]), 6); \
+        out[3] = V_ADD(e[3], t_); \
+        out[7] = V_SUB(e[3], t_); \
+    } while (0)
+
+/*
+ * Columns: q[a + 16b] for the lanes a of u[c] = Z[a][c], plus yoff, in
+ * -128..128. q and yoff are read and written with a stride of 16.
+ */
+TARGET static inline __attribute__((always_inline)) void
+FN(ntt_cols)(const V u[16], const unsigned short *yoff, int16_t *q)
+{
+    NTT_CONSTANTS;
+    V f0[4], f1[4], f2[4], f3[4], e[8], o[8];
+    int b;
+
+    NTT4(u[0], u[4], u[8], u[12], f0);
+    NTT4(u[2], u[6], u[10], u[14], f2);
+    NTT4(u[1], u[5], u[9], u[13], f1);
+    NTT4(u[3], u[7], u[11], u[15], f3);
+    NTT8(f0, f2, e);
+    NTT8(f1, f3, o);
+
+    for (b = 0; b < 8; b++) {
+        V lo, hi;
+
+        BUTTERFLY(e[b], o[b], b, lo, hi);
+        V_STORE(q + 16 * b, CANON(V_ADD(lo, V_LOAD(yoff + 16 * b))));
+        V_STORE(q + 16 * (b + 8), CANON(V_ADD(hi, V_LOAD(yoff + 16 * (b + 8)))));
+    }
+}
+
+#undef RED
+#undef CANON
+#undef V_CANON
+#undef NTT_CONSTANTS
+#undef FFT8
+#undef BUTTERFLY
+#undef NTT4
+#undef NTT8
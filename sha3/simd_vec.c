@@ -0,0 +1,337 @@
+#include "simd_vec.h"
+#include "../cpu.h"
+
+#ifdef CPU_X86
+
+#include <immintrin.h>
+
+#define SSE2        CPU_TARGET("sse2")
+#define AVX2        CPU_TARGET("avx2")
+
+#define LOAD(p)     _mm_loadu_si128((const __m128i*) (p))
+#define STORE(p, x) _mm_storeu_si128((__m128i*) (p), x)
+#define LOAD8(p)    _mm256_loadu_si256((const __m256i*) (p))
+#define STORE8(p, x) _mm256_storeu_si256((__m256i*) (p), x)
+
+/* 41^(a c) mod 257 for a, c < 16, the twiddle factors of simd_ntt_helper.c */
+static const int16_t twiddle[16][16] = {
+    {    1,    1,    1,    1,    1,    1,    1,    1,    1,    1,    1,    1,    1,    1,    1,    1 },
+    {    1,   41, -118,   45,   46,   87,  -31,   14,   60, -110,  116, -127,  -67,   80,  -61,   69 },
+    {    1, -118,   46,  -31,   60,  116,  -67,  -61,    2,   21,   92,  -62,  120,  -25,  123, -122 },
+    {    1,   45,  -31, -110,  -67,   69,   21,  -83,  120,    3, -122,  -93,  -73,   56,  -50,   63 },
+    {    1,   46,   60,  -67,    2,   92,  120,  123,    4,  -73,  -17,  -11,    8,  111,  -34,  -22 },
+    {    1,   87,  116,   69,   92,   37, -122,  -77,  -17,   63,   84,  112,  -22, -115,   18,   24 },
+    {    1,  -31,  -67,   21,  120, -122,  -73,  -50,    8,    9,  -22,  -89,  -68,   52,  -70,  114 },
+    {    1,   14,  -61,  -83,  123,  -77,  -50,   71,  -34,   38,   18,   -5,  -70,   48,  -99, -101 },
+    {    1,   60,    2,  120,    4,  -17,    8,  -34,   16,  -68,   32,  121,   64,  -15,  128,  -30 },
+    {    1, -110,   21,    3,  -73,   63,    9,   38,  -68,   27,  114,   53,   81,   85,  -98,  -14 },
+    {    1,  116,   92, -122,  -17,   84,  -22,   18,   32,  114,  117,  -49,  -30,  118,   67,   62 },
+    {    1, -127,  -62,  -93,  -11,  112,  -89,   -5,  121,   53,  -49,   55,  -46,  -69,   25,  -91 },
+    {    1,  -67,  120,  -73,    8,  -22,  -68,  -70,   64,   81,  -30,  -46,   -2, -123,   17, -111 },
+    {    1,   80,  -25,   56,  111, -115,   52,   48,  -15,   85,  118,  -69, -123,  -74,   -9,   51 },
+    {    1,  -61,  123,  -50,  -34,   18,  -70,  -99,  128,  -98,   67,   25,   17,   -9,   35,  -79 },
+    {    1,   69, -122,   63,  -22,   24,  114, -101,  -30,  -14,   62,  -91, -111,   51,  -79,  -54 },
+};
+
+#define XCAT(x, y)      XCAT_(x, y)
+#define XCAT_(x, y)     x ## y
+
+/* the vector operations simd_ntt_helper.c needs, for the prefix PFX */
+#define V_LOAD(p)           XCAT(PFX, XCAT(loadu_, SI))((const V*) (p))
+#define V_STORE(p, x)       XCAT(PFX, XCAT(storeu_, SI))((V*) (p), x)
+#define V_SET1(x)           XCAT(PFX, set1_epi16)(x)
+#define V_ADD(x, y)         XCAT(PFX, add_epi16)(x, y)
+#define V_SUB(x, y)         XCAT(PFX, sub_epi16)(x, y)
+#define V_MUL(x, y)         XCAT(PFX, mullo_epi16)(x, y)
+#define V_AND(x, y)         XCAT(PFX, XCAT(and_, SI))(x, y)
+#define V_CMPGT(x, y)       XCAT(PFX, cmpgt_epi16)(x, y)
+#define V_SLLI(x, n)        XCAT(PFX, slli_epi16)(x, n)
+#define V_SRAI(x, n)        XCAT(PFX, srai_epi16)(x, n)
+#define V_UNPACKLO16(x, y)  XCAT(PFX, unpacklo_epi16)(x, y)
+#define V_UNPACKHI16(x, y)  XCAT(PFX, unpackhi_epi16)(x, y)
+#define V_UNPACKLO32(x, y)  XCAT(PFX, unpacklo_epi32)(x, y)
+#define V_UNPACKHI32(x, y)  XCAT(PFX, unpackhi_epi32)(x, y)
+#define V_UNPACKLO64(x, y)  XCAT(PFX, unpacklo_epi64)(x, y)
+#define V_UNPACKHI64(x, y)  XCAT(PFX, unpackhi_epi64)(x, y)
+
+#define V           __m128i
+#define PFX         _mm_
+#define SI          si128
+#define TARGET      SSE2
+#define FN(name)    name ## _sse2
+#include "simd_ntt_helper.c"
+#undef V
+#undef PFX
+#undef SI
+#undef TARGET
+#undef FN
+
+#define V           __m256i
+#define PFX         _mm256_
+#define SI          si256
+#define TARGET      AVX2
+#define FN(name)    name ## _avx2
+#include "simd_ntt_helper.c"
+#undef V
+#undef PFX
+#undef SI
+#undef TARGET
+#undef FN
+
+/*
+ * The NTT of msg plus yoff into q. SSE2 takes the columns c < 8 and c >= 8
+ * of the first NTT16, then the rows a < 8 and a >= 8 of the second, as
+ * separate halves; AVX2 has the 16 lanes in one register and moves the
+ * 128-bit halves of the 8x8 transposes in place with VPERM2I128.
+ */
+SSE2 static inline __attribute__((always_inline)) void
+ntt_sse2(const unsigned char *msg, const unsigned short *yoff, int16_t q[256])
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i x0[8], x1[8], z0[16], z1[16], u[16];
+    int d;
+
+    for (d = 0; d < 8; d++) {
+        __m128i m = LOAD(msg + 16 * d);
+
+        x0[d] = _mm_unpacklo_epi8(m, zero);
+        x1[d] = _mm_unpackhi_epi8(m, zero);
+    }
+    ntt_rows_sse2(x0, z0, twiddle[0]);
+    ntt_rows_sse2(x1, z1, twiddle[0] + 8);
+
+    transpose8_sse2(z0, u);
+    transpose8_sse2(z1, u + 8);
+    ntt_cols_sse2(u, yoff, q);
+    transpose8_sse2(z0 + 8, u);
+    transpose8_sse2(z1 + 8, u + 8);
+    ntt_cols_sse2(u, yoff + 8, q + 8);
+}
+
+AVX2 static inline __attribute__((always_inline)) void
+ntt_avx2(const unsigned char *msg, const unsigned short *yoff, int16_t q[256])
+{
+    __m256i x[8], z[16], t0[8], t1[8], u[16];
+    int i;
+
+    for (i = 0; i < 8; i++)
+        x[i] = _mm256_cvtepu8_epi16(LOAD(msg + 16 * i));
+    ntt_rows_avx2(x, z, twiddle[0]);
+
+    transpose8_avx2(z, t0);
+    transpose8_avx2(z + 8, t1);
+    for (i = 0; i < 8; i++) {
+        u[i] = _mm256_permute2x128_si256(t0[i], t1[i], 0x20);
+        u[i + 8] = _mm256_permute2x128_si256(t0[i], t1[i], 0x31);
+    }
+    ntt_cols_avx2(u, yoff, q);
+}
+
+/* the shuffle immediate taking 32-bit lane i from lane i ^ p, p < 4 */
+#define XOR_IMM(p)  ((p) | (((p) ^ 1) << 2) | (((p) ^ 2) << 4) | (((p) ^ 3) << 6))
+
+/*
+ * The message words of a step from the NTT output: the 16-bit pairs of row
+ * sb times 185 in the first two rounds; in the last two, times 233, the
+ * even (round 2) or odd (round 3) elements of two earlier rows. p points
+ * to row sb, or its second half.
+ */
+#define W185(p)         MUL(LD(p), c185)
+#define W233_EVEN(p)    OR(AND(MUL(LD((p) - 256), c233), lo16), SLLI32(MUL(LD((p) - 128), c233), 16))
+#define W233_ODD(p)     OR(SRLI32(MUL(LD((p) - 384), c233), 16), ANDNOT(lo16, MUL(LD((p) - 256), c233)))
+
+#define IF(x, y, z)     XOR(AND(XOR(y, z), x), z)
+#define MAJ(x, y, z)    OR(AND(x, y), AND(OR(x, y), z))
+#define ROL(x, n)       OR(SLLI32(x, n), SRLI32(x, 32 - (n)))
+
+/* SSE2: each of A..D is two registers, the words 0..3 and 4..7 */
+
+#define LD(p)           LOAD(p)
+#define MUL             _mm_mullo_epi16
+#define OR              _mm_or_si128
+#define AND             _mm_and_si128
+#define ANDNOT          _mm_andnot_si128
+#define XOR             _mm_xor_si128
+#define ADD             _mm_add_epi32
+#define SLLI32          _mm_slli_epi32
+#define SRLI32          _mm_srli_epi32
+
+/* tA[n ^ pp] for the words n of each half */
+#define PERM_LO(t0, t1, pp)   _mm_shuffle_epi32((pp) & 4 ? t1 : t0, XOR_IMM((pp) & 3))
+#define PERM_HI(t0, t1, pp)   _mm_shuffle_epi32((pp) & 4 ? t0 : t1, XOR_IMM((pp) & 3))
+
+#define STEP_SSE2(w0, w1, fun, r, s, pp)   do { \
+        __m128i tA0 = ROL(A0, r); \
+        __m128i tA1 = ROL(A1, r); \
+        __m128i t0 = ADD(ADD(D0, w0), fun(A0, B0, C0)); \
+        __m128i t1 = ADD(ADD(D1, w1), fun(A1, B1, C1)); \
+        A0 = ADD(ROL(t0, s), PERM_LO(tA0, tA1, pp)); \
+        A1 = ADD(ROL(t1, s), PERM_HI(tA0, tA1, pp)); \
+        D0 = C0; \
+        D1 = C1; \
+        C0 = B0; \
+        C1 = B1; \
+        B0 = tA0; \
+        B1 = tA1; \
+    } while (0)
+
+#define ROUND_SSE2(W, s0, s1, s2, s3, s4, s5, s6, s7, \
+        p0, p1, p2, p3, pp0, pp1, pp2, pp3, pp4, pp5, pp6, pp7)   do { \
+        STEP_SSE2(W(q + 16 * s0), W(q + 16 * s0 + 8), IF, p0, p1, pp0); \
+        STEP_SSE2(W(q + 16 * s1), W(q + 16 * s1 + 8), IF, p1, p2, pp1); \
+        STEP_SSE2(W(q + 16 * s2), W(q + 16 * s2 + 8), IF, p2, p3, pp2); \
+        STEP_SSE2(W(q + 16 * s3), W(q + 16 * s3 + 8), IF, p3, p0, pp3); \
+        STEP_SSE2(W(q + 16 * s4), W(q + 16 * s4 + 8), MAJ, p0, p1, pp4); \
+        STEP_SSE2(W(q + 16 * s5), W(q + 16 * s5 + 8), MAJ, p1, p2, pp5); \
+        STEP_SSE2(W(q + 16 * s6), W(q + 16 * s6 + 8), MAJ, p2, p3, pp6); \
+        STEP_SSE2(W(q + 16 * s7), W(q + 16 * s7 + 8), MAJ, p3, p0, pp7); \
+    } while (0)
+
+SSE2 static void simd_big_sse2(uint32_t state[32], const unsigned char *msg,
+    const unsigned short *yoff)
+{
+    const __m128i c185 = _mm_set1_epi16(185);
+    const __m128i c233 = _mm_set1_epi16(233);
+    const __m128i lo16 = _mm_set1_epi32(0xFFFF);
+    __m128i A0, A1, B0, B1, C0, C1, D0, D1;
+    int16_t q[256];
+
+    ntt_sse2(msg, yoff, q);
+
+    A0 = XOR(LOAD(state), LOAD(msg));
+    A1 = XOR(LOAD(state + 4), LOAD(msg + 16));
+    B0 = XOR(LOAD(state + 8), LOAD(msg + 32));
+    B1 = XOR(LOAD(state + 12), LOAD(msg + 48));
+    C0 = XOR(LOAD(state + 16), LOAD(msg + 64));
+    C1 = XOR(LOAD(state + 20), LOAD(msg + 80));
+    D0 = XOR(LOAD(state + 24), LOAD(msg + 96));
+    D1 = XOR(LOAD(state + 28), LOAD(msg + 112));
+
+    ROUND_SSE2(W185, 4, 6, 0, 2, 7, 5, 3, 1,
+        3, 23, 17, 27, 1, 6, 2, 3, 5, 7, 4, 1);
+    ROUND_SSE2(W185, 15, 11, 12, 8, 9, 13, 10, 14,
+        28, 19, 22, 7, 6, 2, 3, 5, 7, 4, 1, 6);
+    ROUND_SSE2(W233_EVEN, 17, 18, 23, 20, 22, 21, 16, 19,
+        29, 9, 15, 5, 2, 3, 5, 7, 4, 1, 6, 2);
+    ROUND_SSE2(W233_ODD, 30, 24, 25, 31, 27, 29, 28, 26,
+        4, 13, 10, 25, 3, 5, 7, 4, 1, 6, 2, 3);
+
+    /* the feed-forward: four more steps with the chaining value as message */
+    STEP_SSE2(LOAD(state), LOAD(state + 4), IF, 4, 13, 5);
+    STEP_SSE2(LOAD(state + 8), LOAD(state + 12), IF, 13, 10, 7);
+    STEP_SSE2(LOAD(state + 16), LOAD(state + 20), IF, 10, 25, 4);
+    STEP_SSE2(LOAD(state + 24), LOAD(state + 28), IF, 25, 4, 1);
+
+    STORE(state, A0);
+    STORE(state + 4, A1);
+    STORE(state + 8, B0);
+    STORE(state + 12, B1);
+    STORE(state + 16, C0);
+    STORE(state + 20, C1);
+    STORE(state + 24, D0);
+    STORE(state + 28, D1);
+}
+
+#undef LD
+#undef MUL
+#undef OR
+#undef AND
+#undef ANDNOT
+#undef XOR
+#undef ADD
+#undef SLLI32
+#undef SRLI32
+
+/* AVX2: each of A..D is one register */
+
+#define LD(p)           LOAD8(p)
+#define MUL             _mm256_mullo_epi16
+#define OR              _mm256_or_si256
+#define AND             _mm256_and_si256
+#define ANDNOT          _mm256_andnot_si256
+#define XOR             _mm256_xor_si256
+#define ADD             _mm256_add_epi32
+#define SLLI32          _mm256_slli_epi32
+#define SRLI32          _mm256_srli_epi32
+
+#define PERM(t, pp)     _mm256_shuffle_epi32((pp) & 4 ? _mm256_permute4x64_epi64(t, 0x4E) : t, XOR_IMM((pp) & 3))
+
+#define STEP_AVX2(w, fun, r, s, pp)   do { \
+        __m256i tA = ROL(A, r); \
+        __m256i t = ADD(ADD(D, w), fun(A, B, C)); \
+        A = ADD(ROL(t, s), PERM(tA, pp)); \
+        D = C; \
+        C = B; \
+        B = tA; \
+    } while (0)
+
+#define ROUND_AVX2(W, s0, s1, s2, s3, s4, s5, s6, s7, \
+        p0, p1, p2, p3, pp0, pp1, pp2, pp3, pp4, pp5, pp6, pp7)   do { \
+        STEP_AVX2(W(q + 16 * s0), IF, p0, p1, pp0); \
+        STEP_AVX2(W(q + 16 * s1), IF, p1, p2, pp1); \
+        STEP_AVX2(W(q + 16 * s2), IF, p2, p3, pp2); \
+        STEP_AVX2(W(q + 16 * s3), IF, p3, p0, pp3); \
+        STEP_AVX2(W(q + 16 * s4), MAJ, p0, p1, pp4); \
+        STEP_AVX2(W(q + 16 * s5), MAJ, p1, p2, pp5); \
+        STEP_AVX2(W(q + 16 * s6), MAJ, p2, p3, pp6); \
+        STEP_AVX2(W(q + 16 * s7), MAJ, p3, p0, pp7); \
+    } while (0)
+
+AVX2 static void simd_big_avx2(uint32_t state[32], const unsigned char *msg,
+    const unsigned short *yoff)
+{
+    const __m256i c185 = _mm256_set1_epi16(185);
+    const __m256i c233 = _mm256_set1_epi16(233);
+    const __m256i lo16 = _mm256_set1_epi32(0xFFFF);
+    __m256i A, B, C, D;
+    int16_t q[256];
+
+    ntt_avx2(msg, yoff, q);
+
+    A = XOR(LOAD8(state), LOAD8(msg));
+    B = XOR(LOAD8(state + 8), LOAD8(msg + 32));
+    C = XOR(LOAD8(state + 16), LOAD8(msg + 64));
+    D = XOR(LOAD8(state + 24), LOAD8(msg + 96));
+
+    ROUND_AVX2(W185, 4, 6, 0, 2, 7, 5, 3, 1,
+        3, 23, 17, 27, 1, 6, 2, 3, 5, 7, 4, 1);
+    ROUND_AVX2(W185, 15, 11, 12, 8, 9, 13, 10, 14,
+        28, 19, 22, 7, 6, 2, 3, 5, 7, 4, 1, 6);
+    ROUND_AVX2(W233_EVEN, 17, 18, 23, 20, 22, 21, 16, 19,
+        29, 9, 15, 5, 2, 3, 5, 7, 4, 1, 6, 2);
+    ROUND_AVX2(W233_ODD, 30, 24, 25, 31, 27, 29, 28, 26,
+        4, 13, 10, 25, 3, 5, 7, 4, 1, 6, 2, 3);
+
+    STEP_AVX2(LOAD8(state), IF, 4, 13, 5);
+    STEP_AVX2(LOAD8(state + 8), IF, 13, 10, 7);
+    STEP_AVX2(LOAD8(state + 16), IF, 10, 25, 4);
+    STEP_AVX2(LOAD8(state + 24), IF, 25, 4, 1);
+
+    STORE8(state, A);
+    STORE8(state + 8, B);
+    STORE8(state + 16, C);
+    STORE8(state + 24, D);
+}
+
+int simd_vec_available(void)
+{
+    return (cpu_features() & CPU_FEATURE_SSE2) != 0;
+}
+
+void simd_big_vec_compress(uint32_t state[32], const unsigned char *msg,
+    const unsigned short *yoff)
+{
+    if (cpu_features() & CPU_FEATURE_AVX2)
+        simd_big_avx2(state, msg, yoff);
+    else
+        simd_big_sse2(state, msg, yoff);
+}
+
+#else
+
+int simd_vec_available(void)
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef SIMD_VEC_H
+#define SIMD_VEC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * SIMD-384/512's compression function on SSE2, or AVX2 where the CPU has
+ * it, for sph_simd.c. The message expansion is an NTT over 16-bit lanes and
+ * each of the four 256-bit state registers A..D is one AVX2 register or two
+ * SSE2 ones. state is sph_simd's chaining value, msg one message block and
+ * yoff the offsets added to the NTT, which differ for the last block.
+ */
+
+/* Non-zero when the CPU has SSE2. */
+int simd_vec_available(void);
+
+void simd_big_vec_compress(uint32_t state[32], const unsigned char *msg,
+    const unsigned short *yoff);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
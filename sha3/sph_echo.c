@@ -35,6 +35,8 @@
 #include <limits.h>
 
 #include "sph_echo.h"
+#include "echo_aesni.h"
+#include "../cpu.h"
 
 #ifdef __cplusplus
 extern "C"{
@@ -634,6 +636,16 @@ mix_column(sph_u32 W[16][4], int ia, int ib, int ic, int id)
 
 #endif
 
+/*
+ * On x86, ECHO-384/512 run on AES-NI when the CPU has it (see echo_aesni.c),
+ * which expects the 64-bit state.
+ */
+#if SPH_ECHO_64 && defined CPU_X86
+#define ECHO_AESNI   1
+#else
+#define ECHO_AESNI   0
+#endif
+
 #define INCR_COUNTER(sc, val)   do { \
 		sc->C0 = T32(sc->C0 + (sph_u32)(val)); \
 		if (sc->C0 < (sph_u32)(val)) { \
@@ -724,6 +736,13 @@ echo_big_compress(sph_echo_big_context *sc)
 {
 	DECL_STATE_BIG
 
+#if ECHO_AESNI
+	if (echo_aesni_available()) {
+		echo_big_aesni_compress(sc->u.Vb, sc->buf,
+			sc->C0, sc->C1, sc->C2, sc->C3);
+		return;
+	}
+#endif
 	COMPRESS_BIG(sc);
 }
 
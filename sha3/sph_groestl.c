@@ -34,6 +34,8 @@
 #include <string.h>
 
 #include "sph_groestl.h"
+#include "groestl_aesni.h"
+#include "../cpu.h"
 
 #ifdef __cplusplus
 extern "C"{
@@ -78,6 +80,16 @@ extern "C"{
 #define USE_LE   1
 #endif
 
+/*
+ * On x86, the permutations run on AES-NI when the CPU has it (see
+ * groestl_aesni.c), which expects the 64-bit little-endian state.
+ */
+#if SPH_GROESTL_64 && USE_LE && defined CPU_X86
+#define GROESTL_AESNI   1
+#else
+#define GROESTL_AESNI   0
+#endif
+
 #if USE_LE
 
 #define C32e(x)     ((SPH_C32(x) >> 24) \
@@ -2773,6 +2785,9 @@ groestl_small_core(sph_groestl_small_context *sc, const void *data, size_t len)
 	unsigned char *buf;
 	size_t ptr;
 	DECL_STATE_SMALL
+#if GROESTL_AESNI
+	int aesni = groestl_aesni_available();
+#endif
 
 	buf = sc->buf;
 	ptr = sc->ptr;
@@ -2795,6 +2810,11 @@ groestl_small_core(sph_groestl_small_context *sc, const void *data, size_t len)
 		data = (const unsigned char *)data + clen;
 		len -= clen;
 		if (ptr == sizeof sc->buf) {
+#if GROESTL_AESNI
+			if (aesni)
+				groestl_small_aesni_compress(H, buf);
+			else
+#endif
 			COMPRESS_SMALL;
 #if SPH_64
 			sc->count ++;
@@ -2856,6 +2876,11 @@ groestl_small_close(sph_groestl_small_context *sc,
 #endif
 	groestl_small_core(sc, pad, pad_len);
 	READ_STATE_SMALL(sc);
+#if GROESTL_AESNI
+	if (groestl_aesni_available())
+		groestl_small_aesni_final(H);
+	else
+#endif
 	FINAL_SMALL;
 #if SPH_GROESTL_64
 	for (u = 0; u < 4; u ++)
@@ -2907,6 +2932,9 @@ groestl_big_core(sph_groestl_big_context *sc, const void *data, size_t len)
 	unsigned char *buf;
 	size_t ptr;
 	DECL_STATE_BIG
+#if GROESTL_AESNI
+	int aesni = groestl_aesni_available();
+#endif
 
 	buf = sc->buf;
 	ptr = sc->ptr;
@@ -2929,6 +2957,11 @@ groestl_big_core(sph_groestl_big_context *sc, const void *data, size_t len)
 		data = (const unsigned char *)data + clen;
 		len -= clen;
 		if (ptr == sizeof sc->buf) {
+#if GROESTL_AESNI
+			if (aesni)
+				groestl_big_aesni_compress(H, buf);
+			else
+#endif
 			COMPRESS_BIG;
 #if SPH_64
 			sc->count ++;
@@ -2990,6 +3023,11 @@ groestl_big_close(sph_groestl_big_context *sc,
 #endif
 	groestl_big_core(sc, pad, pad_len);
 	READ_STATE_BIG(sc);
+#if GROESTL_AESNI
+	if (groestl_aesni_available())
+		groestl_big_aesni_final(H);
+	else
+#endif
 	FINAL_BIG;
 #if SPH_GROESTL_64
 	for (u = 0; u < 8; u ++)
@@ -34,6 +34,8 @@
 #include <string.h>
 
 #include "sph_shavite.h"
+#include "shavite_aesni.h"
+#include "../cpu.h"
 
 #ifdef __cplusplus
 extern "C"{
@@ -49,6 +51,16 @@ extern "C"{
 
 #define C32   SPH_C32
 
+/*
+ * On x86, the compression functions run on AES-NI when the CPU has it (see
+ * shavite_aesni.c).
+ */
+#ifdef CPU_X86
+#define SHAVITE_AESNI   1
+#else
+#define SHAVITE_AESNI   0
+#endif
+
 /*
  * As of round 2 of the SHA-3 competition, the published reference
  * implementation and test vectors are wrong, because they use
@@ -1475,6 +1487,32 @@ c512(sph_shavite_big_context *sc, const void *msg)
 
 #endif
 
+static void
+shavite_small_compress(sph_shavite_small_context *sc, const void *msg)
+{
+#if SHAVITE_AESNI
+	if (shavite_aesni_available()) {
+		shavite_small_aesni_compress(sc->h, msg,
+			sc->count0, sc->count1);
+		return;
+	}
+#endif
+	c256(sc, msg);
+}
+
+static void
+shavite_big_compress(sph_shavite_big_context *sc, const void *msg)
+{
+#if SHAVITE_AESNI
+	if (shavite_aesni_available()) {
+		shavite_big_aesni_compress(sc->h, msg,
+			sc->count0, sc->count1, sc->count2, sc->count3);
+		return;
+	}
+#endif
+	c512(sc, msg);
+}
+
 static void
 shavite_small_init(sph_shavite_small_context *sc, const sph_u32 *iv)
 {
@@ -1505,7 +1543,7 @@ shavite_small_core(sph_shavite_small_context *sc, const void *data, size_t len)
 		if (ptr == sizeof sc->buf) {
 			if ((sc->count0 = SPH_T32(sc->count0 + 512)) == 0)
 				sc->count1 = SPH_T32(sc->count1 + 1);
-			c256(sc, buf);
+			shavite_small_compress(sc, buf);
 			ptr = 0;
 		}
 	}
@@ -1537,7 +1575,7 @@ shavite_small_close(sph_shavite_small_context *sc,
 	} else {
 		buf[ptr ++] = z;
 		memset(buf + ptr, 0, 64 - ptr);
-		c256(sc, buf);
+		shavite_small_compress(sc, buf);
 		memset(buf, 0, 54);
 		sc->count0 = sc->count1 = 0;
 	}
@@ -1545,7 +1583,7 @@ shavite_small_close(sph_shavite_small_context *sc,
 	sph_enc32le(buf + 58, count1);
 	buf[62] = out_size_w32 << 5;
 	buf[63] = out_size_w32 >> 3;
-	c256(sc, buf);
+	shavite_small_compress(sc, buf);
 	for (u = 0; u < out_size_w32; u ++)
 		sph_enc32le((unsigned char *)dst + (u << 2), sc->h[u]);
 }
@@ -1590,7 +1628,7 @@ shavite_big_core(sph_shavite_big_context *sc, const void *data, size_t len)
 					}
 				}
 			}
-			c512(sc, buf);
+			shavite_big_compress(sc, buf);
 			ptr = 0;
 		}
 	}
@@ -1624,7 +1662,7 @@ shavite_big_close(sph_shavite_big_context *sc,
 	} else {
 		buf[ptr ++] = z;
 		memset(buf + ptr, 0, 128 - ptr);
-		c512(sc, buf);
+		shavite_big_compress(sc, buf);
 		memset(buf, 0, 110);
 		sc->count0 = sc->count1 = sc->count2 = sc->count3 = 0;
 	}
@@ -1634,7 +1672,7 @@ shavite_big_close(sph_shavite_big_context *sc,
 	sph_enc32le(buf + 122, count3);
 	buf[126] = out_size_w32 << 5;
 	buf[127] = out_size_w32 >> 3;
-	c512(sc, buf);
+	shavite_big_compress(sc, buf);
 	for (u = 0; u < out_size_w32; u ++)
 		sph_enc32le((unsigned char *)dst + (u << 2), sc->h[u]);
 }
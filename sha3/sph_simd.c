@@ -35,6 +35,8 @@
 #include <limits.h>
 
 #include "sph_simd.h"
+#include "simd_vec.h"
+#include "../cpu.h"
 
 #ifdef __cplusplus
 extern "C"{
@@ -57,6 +59,15 @@ typedef sph_s32 s32;
 #define XCAT(x, y)    XCAT_(x, y)
 #define XCAT_(x, y)   x ## y
 
+/*
+ * On x86, SIMD-384/512 compresses on SSE2 or AVX2 (see simd_vec.c).
+ */
+#ifdef CPU_X86
+#define SIMD_VEC   1
+#else
+#define SIMD_VEC   0
+#endif
+
 /*
  * The powers of 41 modulo 257. We use exponents from 0 to 255, inclusive.
  */
@@ -1604,6 +1615,19 @@ update_small(void *cc, const void *data, size_t len)
 	}
 }
 
+static void
+simd_big_compress(sph_simd_big_context *sc, int last)
+{
+#if SIMD_VEC
+	if (simd_vec_available()) {
+		simd_big_vec_compress(sc->state, sc->buf,
+			last ? yoff_b_f : yoff_b_n);
+		return;
+	}
+#endif
+	compress_big(sc, last);
+}
+
 static void
 update_big(void *cc, const void *data, size_t len)
 {
@@ -1620,7 +1644,7 @@ update_big(void *cc, const void *data, size_t len)
 		data = (const unsigned char *)data + clen;
 		len -= clen;
 		if ((sc->ptr += clen) == sizeof sc->buf) {
-			compress_big(sc, 0);
+			simd_big_compress(sc, 0);
 			sc->ptr = 0;
 			sc->count_low = T32(sc->count_low + 1);
 			if (sc->count_low == 0)
@@ -1685,11 +1709,11 @@ finalize_big(void *cc, unsigned ub, unsigned n, void *dst, size_t dst_len)
 		memset(sc->buf + sc->ptr, 0,
 			(sizeof sc->buf) - sc->ptr);
 		sc->buf[sc->ptr] = ub & (0xFF << (8 - n));
-		compress_big(sc, 0);
+		simd_big_compress(sc, 0);
 	}
 	memset(sc->buf, 0, sizeof sc->buf);
 	encode_count_big(sc->buf, sc->count_low, sc->count_high, sc->ptr, n);
-	compress_big(sc, 1);
+	simd_big_compress(sc, 1);
 	d = dst;
 	for (d = dst, u = 0; u < dst_len; u ++)
 		sph_enc32le(d + (u << 2), sc->state[u]);
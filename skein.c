@@ -9,14 +9,11 @@
 
 #include <stdlib.h>
 
-void skein_hash(const char* input, char* output, uint32_t len)
+static void skein_hash_close(sph_skein512_context* ctx_skien, char* output)
 {
     char temp[64];
 
-    sph_skein512_context ctx_skien;
-    sph_skein512_init(&ctx_skien);
-    sph_skein512(&ctx_skien, input, len);
-    sph_skein512_close(&ctx_skien, &temp);
+    sph_skein512_close(ctx_skien, &temp);
     
     SHA256_CTX ctx_sha256;
     SHA256_Init(&ctx_sha256);
@@ -24,3 +21,24 @@ void skein_hash(const char* input, char* output, uint32_t len)
     SHA256_Final((unsigned char*) output, &ctx_sha256);
 }
 
+void skein_hash(const char* input, char* output, uint32_t len)
+{
+    sph_skein512_context ctx_skien;
+    sph_skein512_init(&ctx_skien);
+    sph_skein512(&ctx_skien, input, len);
+    skein_hash_close(&ctx_skien, output);
+}
+
+void skein_hash_prepare(void* state, const char* header)
+{
+    sph_skein512_init(state);
+    sph_skein512(state, header, 76);
+}
+
+void skein_hash_nonce(const void* state, const char* header, char* output)
+{
+    sph_skein512_context ctx_skien = *(const sph_skein512_context*)state;
+    sph_skein512(&ctx_skien, header + 76, 4);
+    skein_hash_close(&ctx_skien, output);
+}
+
@@ -9,6 +9,10 @@ extern "C" {
 
 void skein_hash(const char* input, char* output, uint32_t len);
 
+/* state is a sph_skein512_context with the first 76 header bytes absorbed */
+void skein_hash_prepare(void* state, const char* header);
+void skein_hash_nonce(const void* state, const char* header, char* output);
+
 #ifdef __cplusplus
 }
 #endif
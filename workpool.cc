@@ -0,0 +1,457 @@
+#include "workpool.h"
+#include "scratchpad.h"
+
+#include <stdio.h>
+#include <set>
+#include <utility>
+
+#define BUDGET_WAIT_NS  (5 * 1000000)     // Release() and Notify() wake it sooner
+
+MemoryBudget::MemoryBudget()
+    : limit(0), used(0), generation(0) {
+    uv_mutex_init(&lock);
+    uv_cond_init(&released);
+}
+
+void MemoryBudget::SetLimit(size_t bytes) {
+    uv_mutex_lock(&lock);
+    limit = bytes;
+    generation++;
+    uv_cond_broadcast(&released);
+    uv_mutex_unlock(&lock);
+
+    // arenas kept under the old limit may not fit the new one
+    scratchpad_trim();
+}
+
+size_t MemoryBudget::Limit() {
+    uv_mutex_lock(&lock);
+    size_t bytes = limit;
+    uv_mutex_unlock(&lock);
+
+    return bytes;
+}
+
+size_t MemoryBudget::Used() {
+    uv_mutex_lock(&lock);
+    size_t bytes = used;
+    uv_mutex_unlock(&lock);
+
+    return bytes;
+}
+
+bool MemoryBudget::Acquire(size_t bytes, uint64_t &seen) {
+    if (bytes == 0)
+        return true;
+
+    uv_mutex_lock(&lock);
+    bool fits = limit == 0 || used == 0 || bytes <= limit - used;
+
+    if (fits)
+        used += bytes;
+    else
+        seen = generation;
+    uv_mutex_unlock(&lock);
+
+    return fits;
+}
+
+void MemoryBudget::Release(size_t bytes) {
+    if (bytes == 0)
+        return;
+
+    uv_mutex_lock(&lock);
+    used -= bytes;
+    generation++;
+    uv_cond_broadcast(&released);
+    uv_mutex_unlock(&lock);
+}
+
+void MemoryBudget::Wait(uint64_t seen) {
+    uv_mutex_lock(&lock);
+    if (generation == seen)
+        uv_cond_timedwait(&released, &lock, BUDGET_WAIT_NS);
+    uv_mutex_unlock(&lock);
+}
+
+void MemoryBudget::Notify() {
+    uv_mutex_lock(&lock);
+    generation++;
+    uv_cond_broadcast(&released);
+    uv_mutex_unlock(&lock);
+}
+
+WorkPool::WorkPool(uv_loop_t *loop, size_t threads, MemoryBudget *budget)
+    : budget(budget), active(0), next(0), pending(0), done(NULL), outstanding(0) {
+    uv_rwlock_init(&threads_lock);
+    uv_mutex_init(&idle_lock);
+    uv_cond_init(&idle_cond);
+
+    uv_async_init(loop, &complete, OnComplete);
+    complete.data = this;
+    // only keeps the loop alive while there is work in flight
+    uv_unref((uv_handle_t*) &complete);
+
+    Resize(threads);
+}
+
+void WorkPool::Queue(PoolWorker *worker) {
+    if (outstanding++ == 0)
+        uv_ref((uv_handle_t*) &complete);
+
+    if (worker->Failed()) {
+        Finish(worker);
+        return;
+    }
+
+    for (;;) {
+        Thread *thread = threads[next++ % threads.size()];
+
+        uv_mutex_lock(&thread->lock);
+        if (!thread->retiring) {
+            thread->jobs[worker->options.priority].push_back(worker);
+            uv_mutex_unlock(&thread->lock);
+            break;
+        }
+        uv_mutex_unlock(&thread->lock);
+    }
+
+    uv_mutex_lock(&idle_lock);
+    pending++;
+    uv_cond_signal(&idle_cond);
+    uv_mutex_unlock(&idle_lock);
+
+    // threads blocked on the budget may be able to run the new job
+    if (budget != NULL)
+        budget->Notify();
+}
+
+void WorkPool::Cancel(uint32_t epoch) {
+    std::vector<PoolWorker*> cancelled;
+
+    for (size_t i = 0; i < threads.size(); i++) {
+        Thread *thread = threads[i];
+
+        uv_mutex_lock(&thread->lock);
+        for (int priority = 0; priority < WORK_PRIORITIES; priority++) {
+            std::deque<PoolWorker*> &jobs = thread->jobs[priority];
+            std::deque<PoolWorker*> kept;
+
+            for (size_t j = 0; j < jobs.size(); j++) {
+                if (jobs[j]->options.InEpoch(epoch))
+                    cancelled.push_back(jobs[j]);
+                else
+                    kept.push_back(jobs[j]);
+            }
+            jobs.swap(kept);
+        }
+        uv_mutex_unlock(&thread->lock);
+    }
+
+    if (cancelled.empty())
+        return;
+
+    uv_mutex_lock(&idle_lock);
+    pending -= cancelled.size();
+    uv_mutex_unlock(&idle_lock);
+
+    // completed from the loop like any other job, never inside the caller
+    for (size_t i = 0; i < cancelled.size(); i++) {
+        cancelled[i]->Cancel();
+        Finish(cancelled[i]);
+    }
+}
+
+void WorkPool::Resize(size_t count) {
+    if (count < 1)
+        count = 1;
+
+    Reap();
+
+    for (size_t i = threads.size(); i-- > 0 && active > count; ) {
+        Thread *thread = threads[i];
+
+        uv_mutex_lock(&thread->lock);
+        uv_mutex_lock(&idle_lock);
+        if (!thread->retiring) {
+            thread->retiring = true;
+            active--;
+        }
+        uv_mutex_unlock(&idle_lock);
+        uv_mutex_unlock(&thread->lock);
+    }
+
+    uv_mutex_lock(&idle_lock);
+    uv_cond_broadcast(&idle_cond);
+    uv_mutex_unlock(&idle_lock);
+
+    while (active < count) {
+        Thread *thread = new Thread();
+
+        thread->pool = this;
+        thread->steal_from = threads.size();
+        thread->streak = 0;
+        thread->retiring = false;
+        thread->exited = false;
+        uv_mutex_init(&thread->lock);
+
+        uv_rwlock_wrlock(&threads_lock);
+        threads.push_back(thread);
+        uv_rwlock_wrunlock(&threads_lock);
+
+        uv_thread_create(&thread->thread, ThreadMain, thread);
+        active++;
+    }
+}
+
+// joins the threads that retired since the last resize
+void WorkPool::Reap() {
+    for (size_t i = 0; i < threads.size(); ) {
+        Thread *thread = threads[i];
+
+        uv_mutex_lock(&thread->lock);
+        bool exited = thread->exited;
+        uv_mutex_unlock(&thread->lock);
+
+        if (!exited) {
+            i++;
+            continue;
+        }
+
+        uv_thread_join(&thread->thread);
+
+        uv_rwlock_wrlock(&threads_lock);
+        threads.erase(threads.begin() + i);
+        uv_rwlock_wrunlock(&threads_lock);
+
+        uv_mutex_destroy(&thread->lock);
+        delete thread;
+    }
+}
+
+/*
+ * Returns NULL when there is nothing to run, with blocked set if that is only
+ * because no queued job fits in the memory budget.
+ */
+PoolWorker *WorkPool::Take(Thread *self, bool &blocked, uint64_t &generation) {
+    PoolWorker *worker = NULL;
+
+    blocked = false;
+
+    if (self->streak >= WORK_PRIORITY_STREAK) {
+        for (int priority = WORK_PRIORITIES; priority-- > 0 && worker == NULL; )
+            worker = TakePriority(self, priority, blocked, generation);
+    } else {
+        for (int priority = 0; priority < WORK_PRIORITIES && worker == NULL; priority++)
+            worker = TakePriority(self, priority, blocked, generation);
+    }
+
+    if (worker != NULL) {
+        self->streak = worker->options.priority == WORK_PRIORITY_HIGH ? self->streak + 1 : 0;
+
+        uv_mutex_lock(&idle_lock);
+        pending--;
+        uv_mutex_unlock(&idle_lock);
+    }
+
+    return worker;
+}
+
+// reserves the worker's memory, called with the lock of the deque holding it
+bool WorkPool::Fits(PoolWorker *worker, bool &blocked, uint64_t &generation) {
+    if (budget == NULL || budget->Acquire(worker->memory, generation))
+        return true;
+
+    blocked = true;
+    return false;
+}
+
+/*
+ * Removes the first job of jobs that fits, scanning from the front or the
+ * back, called with the lock of the deque. Jobs at least as large as one
+ * that did not fit are skipped without asking the budget again.
+ */
+PoolWorker *WorkPool::TakeFitting(std::deque<PoolWorker*> &jobs, bool from_back, bool &blocked, uint64_t &generation) {
+    size_t rejected = 0;
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+        size_t j = from_back ? jobs.size() - 1 - i : i;
+        PoolWorker *worker = jobs[j];
+
+        if (rejected != 0 && worker->memory >= rejected)
+            continue;
+
+        if (!Fits(worker, blocked, generation)) {
+            rejected = worker->memory;
+            continue;
+        }
+
+        jobs.erase(jobs.begin() + j);
+        return worker;
+    }
+
+    return NULL;
+}
+
+// own deque first, then the other threads'
+PoolWorker *WorkPool::TakePriority(Thread *self, int priority, bool &blocked, uint64_t &generation) {
+    PoolWorker *worker;
+
+    uv_mutex_lock(&self->lock);
+    worker = TakeFitting(self->jobs[priority], false, blocked, generation);
+    uv_mutex_unlock(&self->lock);
+
+    if (worker == NULL) {
+        uv_rwlock_rdlock(&threads_lock);
+        for (size_t i = 0; i < threads.size() && worker == NULL; i++) {
+            Thread *victim = threads[self->steal_from++ % threads.size()];
+
+            if (victim == self)
+                continue;
+
+            uv_mutex_lock(&victim->lock);
+            worker = TakeFitting(victim->jobs[priority], true, blocked, generation);
+            uv_mutex_unlock(&victim->lock);
+        }
+        uv_rwlock_rdunlock(&threads_lock);
+    }
+
+    return worker;
+}
+
+// sleeps until there is work to take, false once the thread should exit
+bool WorkPool::Waiting(Thread *self, bool blocked, uint64_t generation) {
+    uv_mutex_lock(&self->lock);
+    bool empty = true;
+
+    for (int priority = 0; priority < WORK_PRIORITIES; priority++)
+        empty = empty && self->jobs[priority].empty();
+
+    if (self->retiring && empty) {
+        self->exited = true;
+        uv_mutex_unlock(&self->lock);
+        return false;
+    }
+    uv_mutex_unlock(&self->lock);
+
+    if (blocked) {
+        budget->Wait(generation);
+        return true;
+    }
+
+    uv_mutex_lock(&idle_lock);
+    while (pending == 0 && !self->retiring)
+        uv_cond_wait(&idle_cond, &idle_lock);
+    uv_mutex_unlock(&idle_lock);
+
+    return true;
+}
+
+void WorkPool::ThreadMain(void *arg) {
+    Thread *self = static_cast<Thread*>(arg);
+    WorkPool *pool = self->pool;
+
+    bool blocked;
+    uint64_t generation;
+
+    do {
+        PoolWorker *worker;
+
+        while ((worker = pool->Take(self, blocked, generation)) != NULL) {
+            size_t memory = worker->memory;
+
+            worker->Execute();
+            if (pool->budget != NULL && memory != 0) {
+                size_t limit = pool->budget->Limit();
+
+                pool->budget->Release(memory);
+                // the arena kept for the next job counts against the budget too
+                if (limit != 0)
+                    scratchpad_shrink(limit);
+            }
+            pool->Finish(worker);
+        }
+    } while (pool->Waiting(self, blocked, generation));
+}
+
+void WorkPool::Finish(PoolWorker *worker) {
+    PoolWorker *head = done.load(std::memory_order_relaxed);
+
+    do {
+        worker->next_done = head;
+    } while (!done.compare_exchange_weak(head, worker, std::memory_order_release, std::memory_order_relaxed));
+
+    // a non-empty list already has a wakeup on its way
+    if (head == NULL)
+        uv_async_send(&complete);
+}
+
+void WorkPool::OnComplete(uv_async_t *handle) {
+    WorkPool *pool = static_cast<WorkPool*>(handle->data);
+    PoolWorker *finished = pool->done.exchange(NULL, std::memory_order_acquire);
+    PoolWorker *ordered = NULL;
+    size_t count = 0;
+
+    // the list is newest first, callbacks go out in completion order
+    while (finished != NULL) {
+        PoolWorker *worker = finished;
+
+        finished = worker->next_done;
+        worker->next_done = ordered;
+        ordered = worker;
+    }
+
+    Nan::HandleScope scope;
+
+    while (ordered != NULL) {
+        PoolWorker *worker = ordered;
+
+        ordered = worker->next_done;
+        worker->WorkComplete();
+        worker->Destroy();
+        count++;
+    }
+
+    pool->outstanding -= count;
+    if (pool->outstanding == 0)
+        uv_unref((uv_handle_t*) &pool->complete);
+}
+
+size_t WorkPool::PhysicalCores() {
+    uv_cpu_info_t *cpus;
+    int count;
+
+    if (uv_cpu_info(&cpus, &count) != 0)
+        return 1;
+    uv_free_cpu_info(cpus, count);
+
+    // hyperthread siblings share a (package, core) pair
+    std::set<std::pair<int, int> > cores;
+
+    for (int cpu = 0; cpu < count; cpu++) {
+        char path[128];
+        int package = -1, core = -1;
+        FILE *file;
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+        if ((file = fopen(path, "r")) != NULL) {
+            if (fscanf(file, "%d", &package) != 1)
+                package = -1;
+            fclose(file);
+        }
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+        if ((file = fopen(path, "r")) != NULL) {
+            if (fscanf(file, "%d", &core) != 1)
+                core = -1;
+            fclose(file);
+        }
+
+        if (package < 0 || core < 0)
+            return count > 0 ? count : 1;
+
+        cores.insert(std::make_pair(package, core));
+    }
+
+    return cores.empty() ? 1 : cores.size();
+}
@@ -0,0 +1,161 @@
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <uv.h>
+#include "nan.h"
+
+/*
+ * Native threads for the hashing work, so hashes neither wait behind nor hold
+ * up the libuv threadpool that fs and dns requests share. Each thread owns a
+ * deque per priority: new work is dealt out round-robin, a thread takes from
+ * the front of its own deque and, once that has nothing that fits the memory
+ * budget, steals from the back of the others. High priority work anywhere in the pool goes before normal work.
+ *
+ * Workers are Nan::AsyncWorkers tagged for scheduling. Execute() runs on a
+ * pool thread, WorkComplete() and Destroy() back on the loop thread, which is
+ * also the only thread allowed to call Queue(), Cancel() and Resize().
+ */
+
+#define WORK_PRIORITY_HIGH      0
+#define WORK_PRIORITY_NORMAL    1
+#define WORK_PRIORITIES         2
+
+/*
+ * A thread that took this many high priority jobs in a row looks for normal
+ * ones first, so a steady stream of high priority work cannot starve them.
+ */
+#define WORK_PRIORITY_STREAK    8
+
+/* How a job is scheduled, from the options object of the async call. */
+struct WorkOptions {
+    WorkOptions() : has_epoch(false), epoch(0), priority(WORK_PRIORITY_NORMAL) {
+    }
+
+    // untagged work is never cancelled, whatever epoch is asked for
+    bool InEpoch(uint32_t tag) const {
+        return has_epoch && epoch == tag;
+    }
+
+    bool has_epoch;
+    uint32_t epoch;     // tag for WorkPool::Cancel(), if has_epoch
+    int priority;       // WORK_PRIORITY_*
+};
+
+class PoolWorker : public Nan::AsyncWorker {
+public:
+    explicit PoolWorker(Nan::Callback *callback, const WorkOptions &options = WorkOptions())
+        : Nan::AsyncWorker(callback), options(options), memory(0), next_done(NULL) {
+    }
+
+    // completes with an error instead of running
+    void Fail(const char *message) {
+        SetErrorMessage(message);
+    }
+
+    void Cancel() {
+        Fail("Job was cancelled.");
+    }
+
+    bool Failed() const {
+        return ErrorMessage() != NULL;
+    }
+
+    WorkOptions options;
+    size_t memory;      // scratchpad bytes Execute() needs, see MemoryBudget
+    PoolWorker *next_done;
+};
+
+/*
+ * Scratchpad bytes the running jobs of the pools sharing it may use at once.
+ * A thread only takes a job whose memory fits in what is left; the others
+ * stay queued until running jobs give memory back. A job larger than the
+ * whole budget still runs once nothing else holds any, so it cannot stall.
+ * A thread that finished a job frees its idle scratchpad arena while all
+ * arenas together hold more than the limit, so the memory kept for reuse
+ * stays within the budget too.
+ */
+class MemoryBudget {
+public:
+    MemoryBudget();
+
+    void SetLimit(size_t bytes);    // 0 for no limit, trims the idle arenas
+    size_t Limit();
+    size_t Used();
+
+    // false if the bytes do not fit, generation is then what Wait() takes
+    bool Acquire(size_t bytes, uint64_t &generation);
+    void Release(size_t bytes);
+
+    // sleeps until memory was released or work queued after generation, or a few ms passed
+    void Wait(uint64_t generation);
+    void Notify();                  // wakes Wait(), e.g. for newly queued work
+
+private:
+    uv_mutex_t lock;
+    uv_cond_t released;
+    size_t limit;
+    size_t used;
+    uint64_t generation;
+};
+
+class WorkPool {
+public:
+    WorkPool(uv_loop_t *loop, size_t threads, MemoryBudget *budget = NULL);
+
+    // a worker that already failed completes from the loop without running
+    void Queue(PoolWorker *worker);
+
+    // drops the queued workers of an epoch, workers already running finish
+    void Cancel(uint32_t epoch);
+
+    // threads that already run a job finish it (and their queue) first
+    void Resize(size_t threads);
+    size_t Size() const { return active; }
+
+    // cores without their hyperthread siblings, at least 1
+    static size_t PhysicalCores();
+
+private:
+    struct Thread {
+        WorkPool *pool;
+        uv_thread_t thread;
+        uv_mutex_t lock;
+        std::deque<PoolWorker*> jobs[WORK_PRIORITIES];
+        size_t steal_from;
+        size_t streak;          // high priority jobs taken in a row
+        bool retiring;
+        bool exited;
+    };
+
+    static void ThreadMain(void *arg);
+    static void OnComplete(uv_async_t *handle);
+
+    PoolWorker *Take(Thread *self, bool &blocked, uint64_t &generation);
+    PoolWorker *TakePriority(Thread *self, int priority, bool &blocked, uint64_t &generation);
+    PoolWorker *TakeFitting(std::deque<PoolWorker*> &jobs, bool from_back, bool &blocked, uint64_t &generation);
+    bool Fits(PoolWorker *worker, bool &blocked, uint64_t &generation);
+    void Finish(PoolWorker *worker);
+    bool Waiting(Thread *self, bool blocked, uint64_t generation);
+    void Reap();
+
+    MemoryBudget *budget;           // NULL for no memory limit
+    uv_rwlock_t threads_lock;       // threads vector, written on the loop thread only
+    std::vector<Thread*> threads;
+    size_t active;
+    size_t next;
+
+    uv_mutex_t idle_lock;           // sleeping threads wait for pending > 0
+    uv_cond_t idle_cond;
+    size_t pending;
+
+    // finished workers, pushed lock-free by any thread and taken all at once
+    // by the loop, which is only woken by the push that finds the list empty
+    std::atomic<PoolWorker*> done;
+    uv_async_t complete;
+    size_t outstanding;             // queued but not completed, loop thread only
+};
+
+#endif
@@ -14,14 +14,15 @@
 #include "sha3/sph_cubehash.h"
 #include "sha3/sph_shavite.h"
 #include "sha3/sph_simd.h"
-#include "sha3/sph_echo.h"
+#include "sha3/echo_aesni.h"
 #include "sha3/sph_hamsi.h"
 #include "sha3/sph_fugue.h"
+#include "sha3/blake512_4way.h"
 
 
-void x13_hash(const char* input, char* output, uint32_t len)
+/* stages 2 to 13, from the blake512 digest in hashA */
+static void x13_chain(uint32_t hashA[16], char* output)
 {
-    sph_blake512_context     ctx_blake;
     sph_bmw512_context       ctx_bmw;
     sph_groestl512_context   ctx_groestl;
     sph_skein512_context     ctx_skein;
@@ -31,16 +32,11 @@ void x13_hash(const char* input, char* output, uint32_t len)
     sph_cubehash512_context ctx_cubehash1;
     sph_shavite512_context  ctx_shavite1;
     sph_simd512_context     ctx_simd1;
-    sph_echo512_context     ctx_echo1;
     sph_hamsi512_context    ctx_hamsi1;
     sph_fugue512_context    ctx_fugue1;
 
     //these uint512 in the c++ source of the client are backed by an array of uint32
-    uint32_t hashA[16], hashB[16];
-
-    sph_blake512_init(&ctx_blake);
-    sph_blake512 (&ctx_blake, input, len);
-    sph_blake512_close (&ctx_blake, hashA);
+    uint32_t hashB[16];
 
     sph_bmw512_init(&ctx_bmw);
     sph_bmw512 (&ctx_bmw, hashA, 64);
@@ -78,9 +74,7 @@ void x13_hash(const char* input, char* output, uint32_t len)
     sph_simd512 (&ctx_simd1, hashA, 64);
     sph_simd512_close(&ctx_simd1, hashB);
 
-    sph_echo512_init (&ctx_echo1);
-    sph_echo512 (&ctx_echo1, hashB, 64);
-    sph_echo512_close(&ctx_echo1, hashA);
+    echo512_64(hashB, hashA);
 
     sph_hamsi512_init (&ctx_hamsi1);
     sph_hamsi512 (&ctx_hamsi1, hashA, 64);
@@ -95,3 +89,21 @@ void x13_hash(const char* input, char* output, uint32_t len)
     memcpy(output, hashA, 32);
 
 }
+
+void x13_hash(const char* input, char* output, uint32_t len)
+{
+    sph_blake512_context     ctx_blake;
+    uint32_t hashA[16];
+
+    sph_blake512_init(&ctx_blake);
+    sph_blake512 (&ctx_blake, input, len);
+    sph_blake512_close (&ctx_blake, hashA);
+
+    x13_chain(hashA, output);
+}
+
+/* four equal length inputs share one 4-way blake512 pass */
+void x13_multi_hash(const char* const* input, char* const* output, const uint32_t* len, uint32_t count)
+{
+    blake512_4way_chain(input, output, len, count, x13_chain);
+}
@@ -3,3 +3,4 @@
 #include <stdint.h>
 
 void x13_hash(const char* input, char* output, uint32_t len);
+void x13_multi_hash(const char* const* input, char* const* output, const uint32_t* len, uint32_t count);
@@ -14,14 +14,15 @@
 #include "sha3/sph_cubehash.h"
 #include "sha3/sph_shavite.h"
 #include "sha3/sph_simd.h"
-#include "sha3/sph_echo.h"
+#include "sha3/echo_aesni.h"
 #include "sha3/sph_hamsi.h"
 #include "sha3/sph_fugue.h"
 #include "sha3/sph_shabal.h"
+#include "sha3/blake512_4way.h"
 
-void x14_hash(const char* input, char* output, uint32_t len)
+/* stages 2 to 14, from the blake512 digest in hashA */
+static void x14_chain(uint32_t hashA[16], char* output)
 {
-    sph_blake512_context     ctx_blake;
     sph_bmw512_context       ctx_bmw;
     sph_groestl512_context   ctx_groestl;
     sph_skein512_context     ctx_skein;
@@ -31,17 +32,12 @@ void x14_hash(const char* input, char* output, uint32_t len)
     sph_cubehash512_context	ctx_cubehash1;
     sph_shavite512_context	ctx_shavite1;
     sph_simd512_context		ctx_simd1;
-    sph_echo512_context		ctx_echo1;
     sph_hamsi512_context	ctx_hamsi1;
     sph_fugue512_context	ctx_fugue1;
     sph_shabal512_context	ctx_shabal1;
 
     //these uint512 in the c++ source of the client are backed by an array of uint32
-    uint32_t hashA[16], hashB[16];	
-
-    sph_blake512_init(&ctx_blake);
-    sph_blake512 (&ctx_blake, input, 80);
-    sph_blake512_close (&ctx_blake, hashA);
+    uint32_t hashB[16];	
 
     sph_bmw512_init(&ctx_bmw);
     sph_bmw512 (&ctx_bmw, hashA, 64);
@@ -79,9 +75,7 @@ void x14_hash(const char* input, char* output, uint32_t len)
     sph_simd512 (&ctx_simd1, hashA, 64);   
     sph_simd512_close(&ctx_simd1, hashB); 
     
-    sph_echo512_init (&ctx_echo1); 
-    sph_echo512 (&ctx_echo1, hashB, 64);   
-    sph_echo512_close(&ctx_echo1, hashA); 
+    echo512_64(hashB, hashA);
 
     sph_hamsi512_init (&ctx_hamsi1);
     sph_hamsi512 (&ctx_hamsi1, hashA, 64);
@@ -99,3 +93,21 @@ void x14_hash(const char* input, char* output, uint32_t len)
 
     memcpy(output, hashB, 32);
 }
+
+void x14_hash(const char* input, char* output, uint32_t len)
+{
+    sph_blake512_context     ctx_blake;
+    uint32_t hashA[16];
+
+    sph_blake512_init(&ctx_blake);
+    sph_blake512 (&ctx_blake, input, 80);
+    sph_blake512_close (&ctx_blake, hashA);
+
+    x14_chain(hashA, output);
+}
+
+/* four inputs share one 4-way blake512 pass, each hashed as 80 bytes like x14_hash */
+void x14_multi_hash(const char* const* input, char* const* output, uint32_t count)
+{
+    blake512_4way_chain(input, output, NULL, count, x14_chain);
+}
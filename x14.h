@@ -3,3 +3,4 @@
 #include <stdint.h>
 
 void x14_hash(const char* input, char* output, uint32_t len);
+void x14_multi_hash(const char* const* input, char* const* output, uint32_t count);
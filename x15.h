@@ -8,6 +8,7 @@ extern "C" {
 #include <stdint.h>
 
 void x15_hash(const char* input, char* output, uint32_t len);
+void x15_multi_hash(const char* const* input, char* const* output, const uint32_t* len, uint32_t count);
 
 #ifdef __cplusplus
 }
@@ -13,17 +13,18 @@
 #include "sha3/sph_cubehash.h"
 #include "sha3/sph_shavite.h"
 #include "sha3/sph_simd.h"
-#include "sha3/sph_echo.h"
+#include "sha3/echo_aesni.h"
 #include "sha3/sph_hamsi.h"
 #include "sha3/sph_fugue.h"
 #include "sha3/sph_shabal.h"
 #include "sha3/sph_whirlpool.h"
 #include "sha3/sph_sha2.h"
 #include "sha3/sph_haval.h"
+#include "sha3/blake512_4way.h"
 
-void x17_hash(const char* input, char* output, uint32_t len)
+/* stages 2 to 17, from the blake512 digest in hash */
+static void x17_chain(uint32_t hash[16], char* output)
 {
-	sph_blake512_context     ctx_blake;
 	sph_bmw512_context       ctx_bmw;
 	sph_groestl512_context   ctx_groestl;
 	sph_skein512_context     ctx_skein;
@@ -33,7 +34,6 @@ void x17_hash(const char* input, char* output, uint32_t len)
 	sph_cubehash512_context  ctx_cubehash1;
 	sph_shavite512_context   ctx_shavite1;
 	sph_simd512_context      ctx_simd1;
-	sph_echo512_context      ctx_echo1;
 	sph_hamsi512_context     ctx_hamsi1;
 	sph_fugue512_context     ctx_fugue1;
 	sph_shabal512_context    ctx_shabal1;
@@ -41,12 +41,6 @@ void x17_hash(const char* input, char* output, uint32_t len)
 	sph_sha512_context       ctx_sha512;
 	sph_haval256_5_context   ctx_haval;
 
-	uint32_t hash[16];
-
-	sph_blake512_init(&ctx_blake);
-	sph_blake512 (&ctx_blake, input, len);
-	sph_blake512_close (&ctx_blake, hash);
-
 	sph_bmw512_init(&ctx_bmw);
 	sph_bmw512 (&ctx_bmw, hash, 64);
 	sph_bmw512_close(&ctx_bmw, hash);
@@ -83,9 +77,7 @@ void x17_hash(const char* input, char* output, uint32_t len)
 	sph_simd512 (&ctx_simd1, hash, 64);
 	sph_simd512_close(&ctx_simd1, hash);
 
-	sph_echo512_init (&ctx_echo1);
-	sph_echo512 (&ctx_echo1, hash, 64);
-	sph_echo512_close(&ctx_echo1, hash);
+	echo512_64(hash, hash);
 
 	sph_hamsi512_init (&ctx_hamsi1);
 	sph_hamsi512 (&ctx_hamsi1, hash, 64);
@@ -113,3 +105,21 @@ void x17_hash(const char* input, char* output, uint32_t len)
 
 	memcpy(output, hash, 32);
 }
+
+void x17_hash(const char* input, char* output, uint32_t len)
+{
+	sph_blake512_context     ctx_blake;
+	uint32_t hash[16];
+
+	sph_blake512_init(&ctx_blake);
+	sph_blake512 (&ctx_blake, input, len);
+	sph_blake512_close (&ctx_blake, hash);
+
+	x17_chain(hash, output);
+}
+
+/* four equal length inputs share one 4-way blake512 pass */
+void x17_multi_hash(const char* const* input, char* const* output, const uint32_t* len, uint32_t count)
+{
+	blake512_4way_chain(input, output, len, count, x17_chain);
+}
@@ -1,5 +1,5 @@
-#ifndef X11_H
-#define X11_H
+#ifndef X5_H
+#define X5_H
 
 #ifdef __cplusplus
 extern "C" {
@@ -7,7 +7,7 @@ extern "C" {
 
 #include <stdint.h>
 
-void x11_hash(const char* input, char* output, uint32_t len);
+void x5_hash(const char* input, char* output);
 
 #ifdef __cplusplus
 }
@@ -22,6 +22,7 @@
 #include <string.h>
 #include <stdio.h>
 #include "yescrypt.h"
+#include "../scratchpad.h"
 
 #define BYTES2CHARS(bytes) \
 	((((bytes) * 8) + 5) / 6)
@@ -335,6 +336,7 @@ yescrypt_bsty(const uint8_t * passwd, size_t passwdlen,
 	static __thread int initialized = 0;
 	static __thread yescrypt_shared_t shared;
 	static __thread yescrypt_local_t local;
+	static __thread int huge_pages = 0;
 	int retval;
 	if (!initialized) {
 /* "shared" could in fact be shared, but it's simpler to keep it private
@@ -347,7 +349,12 @@ yescrypt_bsty(const uint8_t * passwd, size_t passwdlen,
 			return -1;
 		}
 		initialized = 1;
- 	}
+ 	} else if (huge_pages != scratchpad_huge_pages()) {
+/* drop "local" so that it is mapped again with the page size now asked for */
+		yescrypt_free_local(&local);
+		yescrypt_init_local(&local);
+	}
+	huge_pages = scratchpad_huge_pages();
 	retval = yescrypt_kdf(&shared, &local,
 	    passwd, passwdlen, salt, saltlen, N, r, p, 0, YESCRYPT_FLAGS,
 	    buf, buflen);		
@@ -20,6 +20,7 @@
 
 #include <sys/mman.h>
 #include "yescrypt.h"
+#include "../scratchpad.h"
 #define HUGEPAGE_THRESHOLD		(12 * 1024 * 1024)
 
 #ifdef __x86_64__
@@ -42,7 +43,8 @@ alloc_region(yescrypt_region_t * region, size_t size)
 #if defined(MAP_HUGETLB) && defined(HUGEPAGE_SIZE)
 	size_t new_size = size;
 	const size_t hugepage_mask = (size_t)HUGEPAGE_SIZE - 1;
-	if (size >= HUGEPAGE_THRESHOLD && size + hugepage_mask >= size) {
+	if ((size >= HUGEPAGE_THRESHOLD || scratchpad_huge_pages()) &&
+	    size + hugepage_mask >= size) {
 		flags |= MAP_HUGETLB;
 /*
  * Linux's munmap() fails on MAP_HUGETLB mappings if size is not a multiple of
@@ -58,6 +60,10 @@ alloc_region(yescrypt_region_t * region, size_t size)
 	if (flags & MAP_HUGETLB) {
 		flags &= ~MAP_HUGETLB;
 		base = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+#ifdef MADV_HUGEPAGE
+		if (base != MAP_FAILED && scratchpad_huge_pages())
+			madvise(base, size, MADV_HUGEPAGE);
+#endif
 	}
 
 #else